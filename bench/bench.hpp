@@ -0,0 +1,349 @@
+#ifndef IMPL_PTR_BENCH_HPP
+#define IMPL_PTR_BENCH_HPP
+
+#include "../include/impl_ptr.hpp"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <functional>
+#include <string>
+#include <vector>
+
+// A deliberately small self-contained harness: every case is a callable
+// running its body 'iterations' times. The harness calibrates the iteration
+// count to the target time, repeats the measurement and reports the best run
+// (the least disturbed one) in nanoseconds per iteration.
+// Build with optimization (CMAKE_BUILD_TYPE=Release) to get meaningful numbers.
+
+namespace bench
+{
+    using      clock = std::chrono::steady_clock;
+    using   body_type = std::function<void(size_t /*iterations*/)>;
+
+#if defined(__GNUC__)
+    template<typename T> inline void do_not_optimize(T const& value) { asm volatile("" : : "g"(&value) : "memory"); }
+    inline void clobber() { asm volatile("" : : : "memory"); }
+#else
+    template<typename T> inline void do_not_optimize(T const& value)
+    {
+        static void const* volatile sink; sink = &value;
+    }
+    inline void clobber() { std::atomic_signal_fence(std::memory_order_seq_cst); }
+#endif
+
+    struct suite
+    {
+        static suite& instance() { static suite single; return single; }
+
+        void add(std::string name, body_type body) { cases_.push_back({ std::move(name), std::move(body) }); }
+
+        // Usage: <executable> [substring-filter]
+        int
+        run(int argc, char const* argv[])
+        {
+            char const* filter = 1 < argc ? argv[1] : "";
+
+            std::printf("%-48s %14s %12s\n", "benchmark", "ns/iteration", "iterations");
+
+            for (auto const& c : cases_)
+                if (c.name.find(filter) != std::string::npos)
+                    run(c);
+
+            return 0;
+        }
+
+        private:
+
+        struct entry { std::string name; body_type body; };
+
+        static double
+        measure(body_type const& body, size_t iterations)
+        {
+            auto start = clock::now();
+            body(iterations);
+            auto  stop = clock::now();
+
+            return std::chrono::duration<double, std::nano>(stop - start).count();
+        }
+
+        static void
+        run(entry const& c)
+        {
+            double const target = 20e6; // 20ms per repetition
+            size_t   iterations = 1;
+            double      elapsed = 0;
+
+            // Calibrate. Grow the iteration count until a run is long enough to time reliably.
+            for (; (elapsed = measure(c.body, iterations)) < target / 10; iterations *= 2);
+
+            iterations = std::max<size_t>(1, size_t(iterations * target / std::max(elapsed, 1.)));
+
+            double best = measure(c.body, iterations);
+
+            for (int k = 1; k < 5; ++k)
+                best = std::min(best, measure(c.body, iterations));
+
+            std::printf("%-48s %14.2f %12zu\n", c.name.c_str(), best / iterations, iterations);
+            std::fflush(stdout);
+        }
+
+        std::vector<entry> cases_;
+    };
+
+    // Implementation payloads of different sizes. 'value' is what every benchmark reads.
+    template<size_t size>
+    struct payload
+    {
+        static_assert(sizeof(int) < size, "");
+
+        explicit payload(int k) : value(k) {}
+
+        int value;
+        int  data[size / sizeof(int) - 1] = {};
+    };
+
+    enum sizes : size_t { small = 8, medium = 64, large = 1024 };
+
+    // Hands the last freed blocks back (per thread and type). Takes the allocation cost
+    // out of the construct/copy/destroy workloads to expose the cost of dispatching to the
+    // operations of the (invisible) implementation.
+    template<typename type>
+    struct recycling_allocator
+    {
+        using value_type = type;
+
+        recycling_allocator () =default;
+
+        template<typename other_type>
+        recycling_allocator (recycling_allocator<other_type> const&) {}
+
+        type*
+        allocate(size_t num)
+        {
+            cache& c = cache_();
+
+            return static_cast<type*>(num == 1 && c.size ? c.blocks[--c.size] : ::operator new(num * sizeof(type)));
+        }
+        void
+        deallocate(type* p, size_t num)
+        {
+            cache& c = cache_();
+
+            if (num == 1 && c.size < 16) c.blocks[c.size++] = p;
+            else ::operator delete(p);
+        }
+
+        template<typename other_type> bool operator==(recycling_allocator<other_type> const&) const { return  true; }
+        template<typename other_type> bool operator!=(recycling_allocator<other_type> const&) const { return false; }
+
+        private:
+
+        struct cache
+        {
+           ~cache () { while (size) ::operator delete(blocks[--size]); }
+
+            void*  blocks[16];
+            size_t size = 0;
+        };
+        static cache& cache_ () { static thread_local cache c; return c; }
+    };
+
+    // type::make_n(count, k). Instantiated in impl.cpp for the Pimpls (where the implementations are visible).
+    template<typename type> std::vector<type> make_n (size_t count, int k);
+
+    // impl_vector::emplace_back(k) for k in [0, count). Instantiated in impl.cpp for the unique/copied Pimpls.
+    template<typename type> void append_n (boost::impl_vector<type>&, size_t count);
+
+    // x += vx * dt over the 100000 particles (7 fields each) kept as Pimpls in a std::vector,
+    // as plain implementations in a std::vector (contiguous, no Pimpl) and in impl_soa.
+    // Defined in impl.cpp (where the implementation is visible). The containers are built on the first run.
+    void advance_pimpls  (size_t iterations);
+    void advance_structs (size_t iterations);
+    void advance_soa     (size_t iterations);
+}
+
+namespace policy = impl_ptr_policy;
+
+// The benchmarked Pimpls. Their implementations live in impl.cpp and are
+// invisible here, exactly as in a real deployment.
+
+template<size_t size>
+struct Shared : boost::impl_ptr<Shared<size>>::shared
+{
+    explicit Shared (int);
+    int value () const;
+};
+
+template<size_t size>
+struct Intrusive : boost::impl_ptr<Intrusive<size>, policy::intrusive>
+{
+    explicit Intrusive (int);
+    int value () const;
+};
+
+template<size_t size>
+struct LocalShared : boost::impl_ptr<LocalShared<size>, policy::local_shared>
+{
+    explicit LocalShared (int);
+    int value () const;
+};
+
+template<size_t size>
+struct Biased : boost::impl_ptr<Biased<size>, policy::biased>
+{
+    explicit Biased (int);
+    int value () const;
+};
+
+template<size_t size>
+struct Replicated : boost::impl_ptr<Replicated<size>, policy::replicated>
+{
+    explicit Replicated (int);
+    int value () const;
+};
+
+template<size_t size>
+struct Unique : boost::impl_ptr<Unique<size>>::unique
+{
+    explicit Unique (int);
+    int value () const;
+};
+
+template<size_t size>
+struct Copied : boost::impl_ptr<Copied<size>>::copied
+{
+    explicit Copied (int);
+    int value () const;
+};
+
+template<size_t size>
+struct Batch : boost::impl_ptr<Batch<size>, policy::copied_batch>
+{
+    explicit Batch (int);
+    int value () const;
+};
+
+template<size_t size>
+struct Cow : boost::impl_ptr<Cow<size>, policy::cow>
+{
+    explicit Cow (int);
+    int value () const;
+};
+
+template<size_t size>
+struct Lazy : boost::impl_ptr<Lazy<size>, policy::lazy>
+{
+    explicit Lazy (int);
+    int value () const;
+};
+
+template<size_t size>
+struct InPlace : boost::impl_ptr<InPlace<size>, policy::inplace, policy::storage<size>>
+{
+    explicit InPlace (int);
+    int value () const;
+};
+
+template<size_t size>
+struct AlwaysInPlace : boost::impl_ptr<AlwaysInPlace<size>, policy::always_inplace, policy::storage<size>>
+{
+    explicit AlwaysInPlace (int);
+    int value () const;
+};
+
+template<size_t size>
+struct TrivialInPlace : boost::impl_ptr<TrivialInPlace<size>, policy::inplace, policy::storage<size>, policy::trivially_copyable>
+{
+    explicit TrivialInPlace (int);
+    int value () const;
+};
+
+// Small and medium implementations in place, large ones on the heap.
+template<size_t size>
+struct Small : boost::impl_ptr<Small<size>, policy::small, policy::storage<bench::medium>>
+{
+    explicit Small (int);
+    int value () const;
+};
+
+template<size_t size>
+struct Region : boost::impl_ptr<Region<size>, policy::region>
+{
+    explicit Region (int);
+    int value () const;
+};
+
+template<size_t size>
+struct Pool : boost::impl_ptr<Pool<size>, policy::pool>
+{
+    explicit Pool (int);
+    int value () const;
+};
+
+template<size_t size>
+struct Affine : boost::impl_ptr<Affine<size>, policy::affine>
+{
+    explicit Affine (int);
+    int value () const;
+};
+
+// Only a few fields of each read by the analytics loops.
+struct Particle : boost::impl_ptr<Particle, policy::copied>
+{
+    explicit Particle (int);
+    double x () const;
+};
+
+// Unique-entry collections by key: the documented mutex + std::map pattern
+// ("Extendible Unique-Entry Collection") and impl_ptr_interned.
+
+struct Mapped : boost::impl_ptr<Mapped>::shared
+{
+    explicit Mapped (std::string const&);
+    int value () const;
+};
+
+struct Interned : boost::impl_ptr<Interned>::shared
+{
+    explicit Interned (boost::string_view);
+    int value () const;
+};
+
+// Constructed, copied and destroyed without the allocation cost (see recycling_allocator).
+struct Dispatched : boost::impl_ptr<Dispatched, policy::copied, bench::recycling_allocator<void>>
+{
+    explicit Dispatched (int);
+    int value () const;
+};
+
+// Raw baselines with no Pimpl involved: fully visible and inlinable.
+
+template<size_t size>
+struct Value
+{
+    explicit Value (int k) : impl_(k) {}
+    int value () const { return impl_.value; }
+
+    private: bench::payload<size> impl_;
+};
+
+template<size_t size>
+struct UniquePtr
+{
+    explicit UniquePtr (int k) : impl_(new bench::payload<size>(k)) {}
+    int value () const { return impl_->value; }
+
+    private: std::unique_ptr<bench::payload<size>> impl_;
+};
+
+template<size_t size>
+struct SharedPtr
+{
+    explicit SharedPtr (int k) : impl_(std::make_shared<bench::payload<size>>(k)) {}
+    int value () const { return impl_->value; }
+
+    private: std::shared_ptr<bench::payload<size>> impl_;
+};
+
+#endif // IMPL_PTR_BENCH_HPP
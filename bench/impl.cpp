@@ -0,0 +1,196 @@
+#include "./bench.hpp"
+#include <boost/fusion/include/adapt_struct.hpp>
+#include <map>
+#include <mutex>
+
+template<typename type>
+std::vector<type>
+bench::make_n(size_t count, int k)
+{
+    return type::make_n(count, k);
+}
+
+template<typename type>
+void
+bench::append_n(boost::impl_vector<type>& objects, size_t count)
+{
+    for (size_t k = 0; k < count; ++k)
+        objects.emplace_back(static_cast<int>(k));
+}
+
+#define BENCH_IMPLEMENTATION(user_template, size)                           \
+                                                                            \
+    template<> struct boost::impl_ptr<user_template<size>>::implementation  \
+    :                                                                       \
+        bench::payload<size>                                                \
+    {                                                                       \
+        using bench::payload<size>::payload;                                \
+    };                                                                      \
+                                                                            \
+    template struct user_template<size>;                                    \
+    template std::vector<user_template<size>> bench::make_n(size_t, int);
+
+#define BENCH_IMPLEMENTATIONS(user_template)                                \
+                                                                            \
+    template<size_t size>                                                   \
+    user_template<size>::user_template (int k)                              \
+    :                                                                       \
+        user_template::impl_ptr_type(user_template::in_place, k)            \
+    {}                                                                      \
+                                                                            \
+    template<size_t size>                                                   \
+    int user_template<size>::value () const { return (*this)->value; }      \
+                                                                            \
+    BENCH_IMPLEMENTATION(user_template, bench::small)                       \
+    BENCH_IMPLEMENTATION(user_template, bench::medium)                      \
+    BENCH_IMPLEMENTATION(user_template, bench::large)
+
+BENCH_IMPLEMENTATIONS(Shared)
+BENCH_IMPLEMENTATIONS(Intrusive)
+BENCH_IMPLEMENTATIONS(LocalShared)
+BENCH_IMPLEMENTATIONS(Biased)
+BENCH_IMPLEMENTATIONS(Replicated)
+BENCH_IMPLEMENTATIONS(Unique)
+BENCH_IMPLEMENTATIONS(Copied)
+BENCH_IMPLEMENTATIONS(Batch)
+BENCH_IMPLEMENTATIONS(Cow)
+BENCH_IMPLEMENTATIONS(Lazy)
+BENCH_IMPLEMENTATIONS(InPlace)
+BENCH_IMPLEMENTATIONS(AlwaysInPlace)
+BENCH_IMPLEMENTATIONS(TrivialInPlace)
+BENCH_IMPLEMENTATIONS(Small)
+BENCH_IMPLEMENTATIONS(Region)
+BENCH_IMPLEMENTATIONS(Pool)
+BENCH_IMPLEMENTATIONS(Affine)
+
+template void bench::append_n(boost::impl_vector<Unique<bench::small>>&, size_t);
+template void bench::append_n(boost::impl_vector<Unique<bench::medium>>&, size_t);
+template void bench::append_n(boost::impl_vector<Copied<bench::small>>&, size_t);
+template void bench::append_n(boost::impl_vector<Copied<bench::medium>>&, size_t);
+
+template<> struct boost::impl_ptr<Particle>::implementation
+{
+    implementation (double x, double y, double z, double vx, double vy, double vz, double mass)
+    :
+        x(x), y(y), z(z), vx(vx), vy(vy), vz(vz), mass(mass)
+    {}
+    explicit implementation (int k) : implementation(k, k, k, 1, 1, 1, 1) {}
+
+    double x, y, z;
+    double vx, vy, vz;
+    double mass;
+};
+
+BOOST_FUSION_ADAPT_STRUCT(boost::impl_ptr<Particle>::implementation, x, y, z, vx, vy, vz, mass)
+
+Particle::Particle (int k) : impl_ptr_type(in_place, k) {}
+
+double Particle::x () const { return (*this)->x; }
+
+namespace
+{
+    using particle = boost::impl_ptr<Particle>::implementation;
+
+    size_t const num_particles = 100000;
+    double const            dt = 1e-3;
+}
+
+void
+bench::advance_pimpls(size_t iterations)
+{
+    static std::vector<Particle> particles;
+
+    for (size_t k = particles.size(); k < num_particles; ++k)
+        particles.emplace_back(int(k));
+
+    for (size_t k = 0; k < iterations; ++k)
+    {
+        for (Particle& p : particles)
+            p->x += p->vx * dt;
+
+        bench::clobber();
+    }
+}
+
+void
+bench::advance_structs(size_t iterations)
+{
+    static std::vector<particle> particles;
+
+    for (size_t k = particles.size(); k < num_particles; ++k)
+        particles.emplace_back(int(k));
+
+    for (size_t k = 0; k < iterations; ++k)
+    {
+        for (particle& p : particles)
+            p.x += p.vx * dt;
+
+        bench::clobber();
+    }
+}
+
+void
+bench::advance_soa(size_t iterations)
+{
+    static boost::impl_soa<Particle> particles;
+
+    for (size_t k = particles.size(); k < num_particles; ++k)
+        particles.emplace_back(int(k));
+
+    for (size_t k = 0; k < iterations; ++k)
+    {
+        double*       x = particles.column<0>().data();
+        double const* v = particles.column<3>().data();
+
+        for (size_t n = 0; n < particles.size(); ++n)
+            x[n] += v[n] * dt;
+
+        bench::clobber();
+    }
+}
+
+template<> struct boost::impl_ptr<Mapped>::implementation
+{
+    explicit implementation(std::string const& key) : value(int(key.size())) {}
+
+    int value;
+};
+
+Mapped::Mapped(std::string const& key) : impl_ptr_type(nullptr)
+{
+    static std::mutex                    mutex;
+    static std::map<std::string, Mapped> all;
+    std::lock_guard<std::mutex>          lock (mutex);
+    auto                               result = all.emplace(key, boost::impl_ptr<Mapped>::null());
+    Mapped&                             entry = result.first->second;
+
+    if (result.second)
+        entry.emplace(key);
+
+    *this = entry;
+}
+
+int Mapped::value () const { return (*this)->value; }
+
+template<> struct boost::impl_ptr<Interned>::implementation
+{
+    explicit implementation(boost::string_view key) : value(int(key.size())) {}
+
+    int value;
+};
+
+Interned::Interned(boost::string_view key) : impl_ptr_type(nullptr)
+{
+    *this = boost::impl_ptr_interned<Interned>::get(key, key);
+}
+
+int Interned::value () const { return (*this)->value; }
+
+template<> struct boost::impl_ptr<Dispatched>::implementation : bench::payload<bench::small>
+{
+    using bench::payload<bench::small>::payload;
+};
+
+Dispatched::Dispatched (int k) : impl_ptr_type(in_place, k) {}
+
+int Dispatched::value () const { return (*this)->value; }
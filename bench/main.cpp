@@ -0,0 +1,329 @@
+#include "./bench.hpp"
+#include <boost/core/ignore_unused.hpp>
+#include <numeric>
+#include <random>
+
+namespace
+{
+    size_t constexpr batch = 1000; // Elements per container-based workload.
+
+    std::vector<int>
+    shuffled_seeds()
+    {
+        std::vector<int> seeds (batch);
+
+        std::iota(seeds.begin(), seeds.end(), 0);
+        std::shuffle(seeds.begin(), seeds.end(), std::mt19937(batch));
+
+        return seeds;
+    }
+
+    // Batch workloads of region-allocated Pimpls run inside their own region.
+    template<typename type> struct batch_scope { };
+    template<size_t size> struct batch_scope<Region<size>> { impl_ptr_region region; };
+
+    template<typename type>
+    void
+    register_copy(std::string const& name, std::true_type /*copyable*/)
+    {
+        bench::suite::instance().add(name + "copy", [](size_t iterations)
+        {
+            type const from (1);
+
+            for (size_t k = 0; k < iterations; ++k)
+            {
+                type copy (from);
+                bench::do_not_optimize(copy);
+            }
+        });
+        bench::suite::instance().add(name + "copy_assign", [](size_t iterations)
+        {
+            type const from (1);
+            type         to (2);
+
+            for (size_t k = 0; k < iterations; ++k)
+            {
+                to = from;
+                bench::do_not_optimize(to);
+            }
+        });
+    }
+
+    template<typename type>
+    void
+    register_copy(std::string const&, std::false_type /*copyable*/)
+    {
+    }
+
+    // Pimpls only: building a container with make_n() (in one block with batch policies).
+    template<typename type>
+    void
+    register_make_n(std::string const& name, std::true_type /*pimpl*/)
+    {
+        bench::suite::instance().add(name + "make_n/" + std::to_string(batch), [](size_t iterations)
+        {
+            for (size_t k = 0; k < iterations; ++k)
+            {
+                std::vector<type> objects = bench::make_n<type>(batch, 1);
+                bench::do_not_optimize(objects.data());
+            }
+        });
+    }
+
+    template<typename type>
+    void
+    register_make_n(std::string const&, std::false_type /*pimpl*/)
+    {
+    }
+
+    template<typename type>
+    void
+    register_type(std::string const& policy, std::string const& size)
+    {
+        std::string name = policy + "/" + size + "/";
+        auto&      suite = bench::suite::instance();
+
+        // Construction and destruction of one object.
+        suite.add(name + "construct", [](size_t iterations)
+        {
+            for (size_t k = 0; k < iterations; ++k)
+            {
+                type object (static_cast<int>(k));
+                bench::do_not_optimize(object);
+            }
+        });
+
+        register_copy<type>(name, std::is_copy_constructible<type>());
+
+        // Move-constructing one object away and move-assigning it back.
+        suite.add(name + "move", [](size_t iterations)
+        {
+            type object (1);
+
+            for (size_t k = 0; k < iterations; ++k)
+            {
+                type moved (std::move(object));
+                object = std::move(moved);
+                bench::do_not_optimize(object);
+            }
+        });
+
+        // Reading through operator-> (via the interface) across a container.
+        suite.add(name + "access/" + std::to_string(batch), [](size_t iterations)
+        {
+            std::vector<type> objects;
+
+            for (int seed : shuffled_seeds())
+                objects.emplace_back(seed);
+
+            for (size_t k = 0; k < iterations; ++k)
+            {
+                int sum = 0;
+
+                for (auto const& object : objects)
+                    sum += object.value();
+
+                bench::do_not_optimize(sum);
+            }
+        });
+
+        // Growing a container without reserve(), i.e. with reallocations.
+        suite.add(name + "vector_growth/" + std::to_string(batch), [](size_t iterations)
+        {
+            for (size_t k = 0; k < iterations; ++k)
+            {
+                std::vector<type> objects;
+
+                for (size_t i = 0; i < batch; ++i)
+                    objects.emplace_back(static_cast<int>(i));
+
+                bench::do_not_optimize(objects.data());
+            }
+        });
+
+        // Building a (reserved) container of objects living as long as one batch.
+        suite.add(name + "batch/" + std::to_string(batch), [](size_t iterations)
+        {
+            for (size_t k = 0; k < iterations; ++k)
+            {
+                batch_scope<type>   scope;
+                std::vector<type> objects;
+
+                boost::ignore_unused(scope);
+                objects.reserve(batch);
+
+                for (size_t i = 0; i < batch; ++i)
+                    objects.emplace_back(static_cast<int>(i));
+
+                bench::do_not_optimize(objects.data());
+            }
+        });
+
+        register_make_n<type>(name, std::integral_constant<bool, boost::is_impl_ptr<type>::value>());
+
+        // Building a (reserved) container and sorting it by value. Includes the build cost.
+        suite.add(name + "vector_sort/" + std::to_string(batch), [](size_t iterations)
+        {
+            std::vector<int> const seeds = shuffled_seeds();
+
+            for (size_t k = 0; k < iterations; ++k)
+            {
+                std::vector<type> objects;
+
+                objects.reserve(batch);
+
+                for (int seed : seeds)
+                    objects.emplace_back(seed);
+
+                std::sort(objects.begin(), objects.end(), [](type const& a, type const& b)
+                {
+                    return a.value() < b.value();
+                });
+                bench::do_not_optimize(objects.data());
+            }
+        });
+    }
+
+    // Scanning 100000 elements (more than the caches): a std::vector after churn (shuffled,
+    // i.e. the implementations scattered), a std::vector in the construction order and
+    // impl_vector. The containers are built once, on the first run.
+    template<typename type>
+    std::vector<type> const&
+    scan_vector(bool shuffled)
+    {
+        static std::vector<type> objects[2];
+        std::vector<type>&       result = objects[shuffled];
+
+        if (result.empty())
+        {
+            for (size_t k = 0; k < 100000; ++k)
+                result.emplace_back(static_cast<int>(k));
+
+            if (shuffled)
+                std::shuffle(result.begin(), result.end(), std::mt19937(batch));
+        }
+        return result;
+    }
+
+    template<typename type>
+    boost::impl_vector<type> const&
+    scan_impl_vector()
+    {
+        static boost::impl_vector<type> objects;
+
+        if (objects.empty())
+            bench::append_n(objects, 100000);
+
+        return objects;
+    }
+
+    template<typename container>
+    void
+    scan(container const& objects, size_t iterations)
+    {
+        for (size_t k = 0; k < iterations; ++k)
+        {
+            int sum = 0;
+
+            for (auto const& object : objects)
+                sum += object.value();
+
+            bench::do_not_optimize(sum);
+        }
+    }
+
+    template<typename type>
+    void
+    register_scan(std::string const& name)
+    {
+        auto& suite = bench::suite::instance();
+
+        suite.add(name + "scan/std::vector/shuffled/100000", [](size_t iterations) { scan(scan_vector<type>(true), iterations); });
+        suite.add(name + "scan/std::vector/ordered/100000",  [](size_t iterations) { scan(scan_vector<type>(false), iterations); });
+        suite.add(name + "scan/impl_vector/100000",          [](size_t iterations) { scan(scan_impl_vector<type>(), iterations); });
+    }
+
+    // The operations of an invisible implementation dispatched through the policy's traits
+    // (constructed through emplace(), copied and destroyed through the traits table).
+    void
+    register_dispatch()
+    {
+        auto& suite = bench::suite::instance();
+
+        suite.add("dispatch/construct_destroy", [](size_t iterations)
+        {
+            for (size_t k = 0; k < iterations; ++k)
+            {
+                Dispatched object (static_cast<int>(k));
+                bench::do_not_optimize(object);
+            }
+        });
+        suite.add("dispatch/copy_destroy", [](size_t iterations)
+        {
+            Dispatched const from (1);
+
+            for (size_t k = 0; k < iterations; ++k)
+            {
+                Dispatched copy (from);
+                bench::do_not_optimize(copy);
+            }
+        });
+        suite.add("dispatch/copy_assign", [](size_t iterations)
+        {
+            Dispatched const from (1);
+            Dispatched         to (2);
+
+            for (size_t k = 0; k < iterations; ++k)
+            {
+                to = from;
+                bench::do_not_optimize(to);
+            }
+        });
+    }
+
+    template<template<size_t> class type>
+    void
+    register_sizes(std::string const& policy)
+    {
+        register_type<type<bench::small >>(policy, "small");
+        register_type<type<bench::medium>>(policy, "medium");
+        register_type<type<bench::large >>(policy, "large");
+    }
+}
+
+int
+main(int argc, char const* argv[])
+{
+    register_sizes<Value         >("value");
+    register_sizes<UniquePtr     >("std::unique_ptr");
+    register_sizes<SharedPtr     >("std::make_shared");
+    register_sizes<Shared        >("shared");
+    register_sizes<Intrusive     >("intrusive");
+    register_sizes<LocalShared   >("local_shared");
+    register_sizes<Biased        >("biased");
+    register_sizes<Unique        >("unique");
+    register_sizes<Copied        >("copied");
+    register_sizes<Batch         >("copied_batch");
+    register_sizes<Cow           >("cow");
+    register_sizes<Lazy          >("lazy");
+    register_sizes<InPlace       >("inplace");
+    register_sizes<AlwaysInPlace >("always_inplace");
+    register_sizes<TrivialInPlace>("trivial_inplace");
+    register_sizes<Small         >("small");
+    register_sizes<Region        >("region");
+    register_sizes<Pool          >("pool");
+    register_sizes<Affine        >("affine");
+
+    register_scan<Unique<bench::small >>("unique/small/");
+    register_scan<Unique<bench::medium>>("unique/medium/");
+    register_scan<Copied<bench::small >>("copied/small/");
+    register_scan<Copied<bench::medium>>("copied/medium/");
+
+    bench::suite::instance().add("particles/advance/pimpls/100000", bench::advance_pimpls);
+    bench::suite::instance().add("particles/advance/structs/100000", bench::advance_structs);
+    bench::suite::instance().add("particles/advance/impl_soa/100000", bench::advance_soa);
+
+    register_dispatch();
+
+    return bench::suite::instance().run(argc, argv);
+}
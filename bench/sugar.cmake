@@ -0,0 +1,10 @@
+sugar_files(BENCH_SOURCES
+        bench.hpp
+        impl.cpp
+        main.cpp
+        )
+sugar_files(BENCH_THREADS_SOURCES
+        bench.hpp
+        impl.cpp
+        threads.cpp
+        )
\ No newline at end of file
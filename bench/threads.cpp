@@ -0,0 +1,332 @@
+#include "./bench.hpp"
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+
+// Contention benchmark for shared Pimpls.
+// The singleton and the dictionary patterns hand out copies of one single
+// implementation. Then every copy/destruction of such a handle is an atomic
+// read-modify-write of the same reference counter, i.e. the counter's cache line
+// bounces between the cores. This benchmark runs the same workload from 1..N
+// threads and reports the throughput for every thread count.
+//
+// The hand-over benchmark constructs Pimpls on a producer thread and destroys
+// them on a consumer thread, the worst case for allocators and naive pools.
+//
+// Usage: impl_ptr_bench_threads [max-threads [operations-per-thread]]
+
+namespace
+{
+    using Single = Shared<bench::small>;
+
+    // All threads start the timed section together, when released by the timing thread.
+    struct start_line
+    {
+        explicit start_line(size_t num_threads) : waiting_(num_threads) {}
+
+        void
+        arrive_and_wait()
+        {
+            std::unique_lock<std::mutex> lock (mutex_);
+
+            if (--waiting_ == 0) cv_.notify_all();
+
+            cv_.wait(lock, [this]{ return released_; });
+        }
+
+        void
+        wait_and_release()
+        {
+            std::unique_lock<std::mutex> lock (mutex_);
+
+            cv_.wait(lock, [this]{ return waiting_ == 0; });
+            released_ = true;
+            cv_.notify_all();
+        }
+
+        private:
+
+        std::mutex             mutex_;
+        std::condition_variable   cv_;
+        size_t               waiting_;
+        bool                released_ = false;
+    };
+
+    using workload = std::function<void(Single const& /*shared*/, size_t /*operations*/)>;
+
+    double
+    run(workload const& work, Single const& single, size_t num_threads, size_t operations)
+    {
+        start_line                 line (num_threads);
+        std::vector<std::thread> threads;
+
+        for (size_t k = 0; k < num_threads; ++k)
+            threads.emplace_back([&]
+            {
+                line.arrive_and_wait();
+                work(single, operations);
+            });
+
+        auto start = (line.wait_and_release(), bench::clock::now());
+
+        for (auto& thread : threads)
+            thread.join();
+
+        return std::chrono::duration<double, std::nano>(bench::clock::now() - start).count();
+    }
+
+    void
+    report(char const* name, workload const& work, size_t max_threads, size_t operations)
+    {
+        Single const single (1); // One implementation shared by all threads.
+
+        std::printf("\n%s\n%8s %16s %20s\n", name, "threads", "Mops/s (total)", "ns/op (per thread)");
+
+        std::vector<size_t> counts;
+
+        for (size_t num_threads = 1; num_threads < max_threads; num_threads *= 2)
+            counts.push_back(num_threads);
+
+        counts.push_back(max_threads);
+
+        for (size_t num_threads : counts)
+        {
+            double elapsed = run(work, single, num_threads, operations);
+
+            for (int k = 1; k < 3; ++k) // Best of three.
+                elapsed = std::min(elapsed, run(work, single, num_threads, operations));
+
+            double const total_ops = double(num_threads) * operations;
+
+            std::printf("%8zu %16.2f %20.2f\n", num_threads, total_ops / elapsed * 1e3, elapsed / operations);
+            std::fflush(stdout);
+        }
+    }
+
+    // Batches of Pimpls constructed by the producer and destroyed by the consumer.
+    template<typename type>
+    double
+    hand_over(size_t operations)
+    {
+        size_t constexpr          batch = 256;
+        size_t const        num_batches = (operations + batch - 1) / batch;
+        std::deque<std::vector<type>> queue;
+        std::mutex                    mutex;
+        std::condition_variable          cv;
+
+        auto start = bench::clock::now();
+
+        std::thread consumer ([&]
+        {
+            for (size_t k = 0; k < num_batches; ++k)
+            {
+                std::unique_lock<std::mutex> lock (mutex);
+
+                cv.wait(lock, [&]{ return !queue.empty(); });
+
+                std::vector<type> objects = std::move(queue.front());
+
+                queue.pop_front();
+                lock.unlock();
+
+                objects.clear(); // Destroyed on the consumer thread.
+            }
+        });
+
+        for (size_t k = 0; k < num_batches; ++k)
+        {
+            std::vector<type> objects;
+
+            objects.reserve(batch);
+
+            for (size_t i = 0; i < batch; ++i)
+                objects.emplace_back(static_cast<int>(i));
+
+            std::lock_guard<std::mutex> lock (mutex);
+
+            queue.push_back(std::move(objects));
+            cv.notify_one();
+        }
+        consumer.join();
+
+        return std::chrono::duration<double, std::nano>(bench::clock::now() - start).count() / (num_batches * batch);
+    }
+
+    template<typename type>
+    void
+    report_hand_over(char const* name, size_t operations)
+    {
+        double best = hand_over<type>(operations);
+
+        for (int k = 1; k < 3; ++k) // Best of three.
+            best = std::min(best, hand_over<type>(operations));
+
+        std::printf("%-16s %14.2f\n", name, best);
+        std::fflush(stdout);
+    }
+}
+
+int
+main(int argc, char const* argv[])
+{
+    size_t const hardware = std::max(1u, std::thread::hardware_concurrency());
+    size_t const  threads = 1 < argc ? std::stoul(argv[1]) : hardware;
+    size_t const      ops = 2 < argc ? std::stoul(argv[2]) : 1 << 20;
+
+    report("copy/destroy handles to one shared implementation",
+        [](Single const& single, size_t operations)
+        {
+            for (size_t k = 0; k < operations; ++k)
+            {
+                Single copy (single);
+                bench::do_not_optimize(copy);
+            }
+        },
+        threads, ops);
+
+    report("copy/read/destroy handles to one shared implementation",
+        [](Single const& single, size_t operations)
+        {
+            int sum = 0;
+
+            for (size_t k = 0; k < operations; ++k)
+                sum += Single(single).value();
+
+            bench::do_not_optimize(sum);
+        },
+        threads, ops);
+
+    Replicated<bench::small> const replicated (1);
+
+    report("replicated: copy/read/destroy handles to one shared implementation",
+        [&replicated](Single const&, size_t operations)
+        {
+            int sum = 0;
+
+            for (size_t k = 0; k < operations; ++k)
+                sum += Replicated<bench::small>(replicated).value();
+
+            bench::do_not_optimize(sum);
+        },
+        threads, ops);
+
+    report("read via operator-> of a thread-own copy of the handle",
+        [](Single const& single, size_t operations)
+        {
+            Single const copy (single);
+            int           sum = 0;
+
+            for (size_t k = 0; k < operations; ++k)
+            {
+                sum += copy.value();
+                bench::clobber();
+            }
+            bench::do_not_optimize(sum);
+        },
+        threads, ops);
+
+    report("baseline: copy/destroy handles to a thread-own implementation",
+        [](Single const&, size_t operations)
+        {
+            Single const own (1);
+
+            for (size_t k = 0; k < operations; ++k)
+            {
+                Single copy (own);
+                bench::do_not_optimize(copy);
+            }
+        },
+        threads, ops);
+
+    report("biased: copy/destroy handles to a thread-own implementation",
+        [](Single const&, size_t operations)
+        {
+            Biased<bench::small> const own (1);
+
+            for (size_t k = 0; k < operations; ++k)
+            {
+                Biased<bench::small> copy (own);
+                bench::do_not_optimize(copy);
+            }
+        },
+        threads, ops);
+
+    // Hot-swapped state: every 65536th operation replaces it.
+    std::mutex                     mutex;
+    Single                         guarded (1);
+    boost::impl_ptr_atomic<Single> published (guarded);
+
+    report("hot-swapped state: read a copy taken under a mutex",
+        [&](Single const&, size_t operations)
+        {
+            int sum = 0;
+
+            for (size_t k = 0; k < operations; ++k)
+            {
+                std::unique_lock<std::mutex> lock (mutex);
+
+                if (!(k & 65535)) guarded = Single(int(k));
+
+                Single copy = guarded;
+
+                lock.unlock();
+                sum += copy.value();
+            }
+            bench::do_not_optimize(sum);
+        },
+        threads, ops);
+
+    report("hot-swapped state: read an impl_ptr_atomic snapshot",
+        [&](Single const&, size_t operations)
+        {
+            int sum = 0;
+
+            for (size_t k = 0; k < operations; ++k)
+            {
+                if (!(k & 65535)) published.store(Single(int(k)));
+
+                sum += published.snapshot()->value();
+            }
+            bench::do_not_optimize(sum);
+        },
+        threads, ops);
+
+    // 1024 keys: all lookups of existing entries after the first run.
+    std::vector<std::string> keys;
+
+    for (int k = 0; k < 1024; ++k)
+        keys.push_back("key-" + std::to_string(k));
+
+    report("construct by key: mutex + std::map (documented unique-entry collection)",
+        [&keys](Single const&, size_t operations)
+        {
+            int sum = 0;
+
+            for (size_t k = 0; k < operations; ++k)
+                sum += Mapped(keys[k & 1023]).value();
+
+            bench::do_not_optimize(sum);
+        },
+        threads, ops);
+
+    report("construct by key: impl_ptr_interned",
+        [&keys](Single const&, size_t operations)
+        {
+            int sum = 0;
+
+            for (size_t k = 0; k < operations; ++k)
+                sum += Interned(keys[k & 1023]).value();
+
+            bench::do_not_optimize(sum);
+        },
+        threads, ops);
+
+    std::printf("\nconstruct on a producer thread, destroy on a consumer thread\n%-16s %14s\n", "policy", "ns/object");
+
+    report_hand_over<Unique<bench::medium>>("unique", ops);
+    report_hand_over<  Pool<bench::medium>>("pool", ops);
+    report_hand_over<Affine<bench::medium>>("affine", ops);
+
+    return 0;
+}
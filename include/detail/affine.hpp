@@ -0,0 +1,232 @@
+// Copyright (c) 2008 Vladimir Batov.
+// Use, modification and distribution are subject to the Boost Software License,
+// Version 1.0. See http://www.boost.org/LICENSE_1_0.txt.
+
+#ifndef IMPL_PTR_DETAIL_AFFINE_HPP
+#define IMPL_PTR_DETAIL_AFFINE_HPP
+
+#include "./unique.hpp"
+#include "./copied.hpp"
+#include <boost/align/aligned_alloc.hpp>
+#include <boost/core/ignore_unused.hpp>
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <new>
+#include <vector>
+
+// Thread-affine allocation for Pimpls created on one thread and destroyed on another
+// (producer/consumer pipelines, I/O thread -> worker thread hand-overs, etc.).
+//
+//     struct Item : boost::impl_ptr<Item, policy::affine> { ... };
+//
+// 1) policy::affine has 'unique' semantics, policy::copied_affine has 'copied' semantics.
+// 2) Every thread has its own heap per implementation type. Implementations are allocated
+//    from the heap of the constructing thread without any synchronization.
+// 3) An implementation destroyed on its origin thread goes back to the local free list.
+//    Destroyed on another thread, it is pushed onto the lock-free return queue of the
+//    origin heap. The origin thread takes the whole queue in one go when its free list
+//    runs out, i.e. the remote frees are reclaimed in batches.
+// 4) The heap of an exited thread is abandoned (with its return queue still accepting
+//    remote frees) and adopted by the next thread needing a heap.
+// 5) Segments are never returned to the system.
+
+namespace detail
+{
+    struct thread_heap_base
+    {
+        static size_t constexpr segment_size = 64 * 1024; // Segments are aligned to their size.
+
+        struct block   { block* next; };
+        struct segment { thread_heap_base* owner; };
+
+        static void
+        deallocate(void* p)
+        {
+            segment* s = reinterpret_cast<segment*>(std::uintptr_t(p) & ~std::uintptr_t(segment_size - 1));
+
+            s->owner->deallocate_(s->owner, static_cast<block*>(p));
+        }
+
+        protected:
+
+        using dealloc_type = void (*)(thread_heap_base*, block*);
+
+        explicit thread_heap_base(dealloc_type d) : deallocate_(d) {}
+
+        // Any thread. Lock-free push onto the return queue.
+        void
+        push_remote(block* b)
+        {
+            block* head = remote_.load(std::memory_order_relaxed);
+
+            do b->next = head;
+            while (!remote_.compare_exchange_weak(head, b, std::memory_order_release, std::memory_order_relaxed));
+        }
+
+        // Owner thread only. The whole queue is taken at once: no ABA problem.
+        block* take_remote () { return remote_.exchange(nullptr, std::memory_order_acquire); }
+
+        dealloc_type const deallocate_;
+        std::atomic<block*>    remote_ { nullptr };
+    };
+
+    template<typename impl_type>
+    struct thread_heap : thread_heap_base
+    {
+        static size_t constexpr    alignment = alignof(impl_type) < alignof(block) ? alignof(block) : alignof(impl_type);
+        static size_t constexpr   block_size = ((sizeof(impl_type) < sizeof(block) ? sizeof(block) : sizeof(impl_type)) + alignment - 1) / alignment * alignment;
+        static size_t constexpr  first_block = (sizeof(segment) + alignment - 1) / alignment * alignment;
+
+        static_assert(first_block + block_size <= segment_size, "Implementation is too large for the affine policy");
+
+        static void*
+        allocate()
+        {
+            thread_heap& heap = local();
+
+            if (BOOST_UNLIKELY(!heap.free_))
+                heap.refill();
+
+            block* b = heap.free_;
+            heap.free_ = b->next;
+
+            return b;
+        }
+
+        private:
+
+        // Abandons the heap when the thread exits.
+        struct thread_cache
+        {
+           ~thread_cache() { if (heap) abandon(heap); }
+
+            thread_heap* heap = nullptr;
+        };
+
+        struct registry
+        {
+            std::mutex                 mutex;
+            std::vector<thread_heap*> abandoned;
+        };
+
+        thread_heap() : thread_heap_base(&thread_heap::deallocate_) {}
+
+        static thread_cache& cache () { static thread_local thread_cache local; return local; }
+        static registry&  registry_ () { static registry& single = *new registry(); return single; } // Never destroyed.
+
+        static thread_heap&
+        local()
+        {
+            thread_heap*& heap = cache().heap;
+
+            if (BOOST_UNLIKELY(!heap))
+                heap = adopt();
+
+            return *heap;
+        }
+
+        static thread_heap*
+        adopt()
+        {
+            registry& r = registry_();
+            std::lock_guard<std::mutex> lock (r.mutex);
+
+            if (r.abandoned.empty())
+                return new thread_heap(); // Never destroyed. Can be adopted by another thread.
+
+            thread_heap* heap = r.abandoned.back();
+            r.abandoned.pop_back();
+            return heap;
+        }
+
+        static void
+        abandon(thread_heap* heap)
+        {
+            registry& r = registry_();
+            std::lock_guard<std::mutex> lock (r.mutex);
+
+            r.abandoned.push_back(heap);
+        }
+
+        static void
+        deallocate_(thread_heap_base* owner, block* b)
+        {
+            thread_heap* heap = static_cast<thread_heap*>(owner);
+
+            if (heap == cache().heap) // Origin thread.
+            {
+                b->next = heap->free_;
+                heap->free_ = b;
+            }
+            else heap->push_remote(b);
+        }
+
+        void
+        refill()
+        {
+            free_ = take_remote();
+
+            if (free_) return;
+
+            if (cur_ == end_)
+                carve();
+
+            free_ = reinterpret_cast<block*>(cur_);
+            free_->next = nullptr;
+            cur_ += block_size;
+        }
+
+        void
+        carve()
+        {
+            void* memory = boost::alignment::aligned_alloc(segment_size, segment_size);
+
+            if (!memory) throw std::bad_alloc();
+
+            segment* s = new (memory) segment { this };
+
+            cur_ = reinterpret_cast<char*>(s) + first_block;
+            end_ = cur_ + (segment_size - first_block) / block_size * block_size;
+        }
+
+        block* free_ = nullptr; // Owner thread only.
+        char*   cur_ = nullptr; // Not yet used blocks of the last segment.
+        char*   end_ = nullptr;
+    };
+}
+
+namespace impl_ptr_policy
+{
+    template<typename impl_type>
+    struct affine_allocator
+    {
+        using value_type = impl_type;
+
+        affine_allocator () noexcept =default;
+
+        template<typename other_type>
+        affine_allocator (affine_allocator<other_type> const&) noexcept {}
+
+        impl_type*
+        allocate(size_t num)
+        {
+            BOOST_ASSERT(num == 1); // Implementations are allocated one at a time.
+            boost::ignore_unused(num);
+
+            return static_cast<impl_type*>(detail::thread_heap<impl_type>::allocate());
+        }
+        void deallocate(impl_type* p, size_t) noexcept { detail::thread_heap_base::deallocate(p); }
+
+        template<typename other_type> bool operator==(affine_allocator<other_type> const&) const { return true; }
+        template<typename other_type> bool operator!=(affine_allocator<other_type> const&) const { return false; }
+    };
+
+    template<typename impl_type, typename...>
+    using affine = unique<impl_type, affine_allocator<impl_type>>;
+
+    template<typename impl_type, typename...>
+    using copied_affine = copied<impl_type, affine_allocator<impl_type>>;
+}
+
+#endif // IMPL_PTR_DETAIL_AFFINE_HPP
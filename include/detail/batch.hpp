@@ -0,0 +1,213 @@
+// Copyright (c) 2008 Vladimir Batov.
+// Use, modification and distribution are subject to the Boost Software License,
+// Version 1.0. See http://www.boost.org/LICENSE_1_0.txt.
+
+#ifndef IMPL_PTR_DETAIL_BATCH_HPP
+#define IMPL_PTR_DETAIL_BATCH_HPP
+
+#include "./unique.hpp"
+#include "./copied.hpp"
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <new>
+
+// Batch allocation: the implementations of a batch in one contiguous block.
+//
+//     struct Item : boost::impl_ptr<Item, policy::copied_batch> { ... };
+//
+//     std::vector<Item> items  = Item::make_n(100000, args);               // One allocation.
+//     std::vector<Item> copies = Item::clone(items.begin(), items.end()); // One allocation.
+//
+// 1) policy::batch has 'unique' semantics, policy::copied_batch has 'copied' semantics.
+//    make_n() and clone() are available for all policies. With other policies, they
+//    construct the implementations one by one.
+// 2) While make_n()/clone() runs, the batch block is the current one of the thread.
+//    Implementations of the batch size and alignment are bump-allocated from it. Other
+//    allocations (derived types, the implementations created outside make_n()/clone(),
+//    the ones beyond the batch count) are from the heap.
+// 3) The block is released when its last implementation is destroyed (on any thread).
+//    Every implementation is prefixed with a pointer to its block. On the heap, the prefix
+//    holds its own offset instead (tagged): derived types are released through the allocator
+//    of the base, which does not know the alignment they were allocated with.
+// 4) The allocator is stateless. Then, the handle is one pointer.
+// 5) Blocks and heap allocations are from plain operator new. Then, over-aligned
+//    implementations (beyond std::max_align_t) are rejected at compile time.
+
+namespace detail
+{
+    struct batch_block
+    {
+        // The offset of an implementation from its slot (room for the block pointer).
+        static size_t prefix (size_t align) { return (sizeof(batch_block*) + align - 1) / align * align; }
+
+        static batch_block*& current () { static thread_local batch_block* block = nullptr; return block; }
+
+        static batch_block*
+        make(size_t count, size_t size, size_t align)
+        {
+            size_t const  offset = prefix(align);
+            size_t const   round = std::max(align, alignof(batch_block*)); // Keeps the block pointers aligned.
+            size_t const  stride = offset + (size + round - 1) / round * round;
+            size_t const  header = (sizeof(batch_block) + alignof(std::max_align_t) - 1) / alignof(std::max_align_t) * alignof(std::max_align_t);
+            char* const   memory = static_cast<char*>(::operator new(header + count * stride));
+            batch_block* const b = ::new (memory) batch_block();
+
+            b->live_.store(count + 1, std::memory_order_relaxed); // All slots counted up-front: no atomic update per allocation.
+            b->size_   = size;
+            b->align_  = align;
+            b->stride_ = stride;
+            b->cur_    = memory + header + offset;
+            b->end_    = b->cur_ + count * stride;
+
+            return b;
+        }
+
+        // Null when not of the batch size and alignment or when the batch is used up.
+        void*
+        allocate(size_t size, size_t align)
+        {
+            if (size != size_ || align != align_ || cur_ == end_)
+                return nullptr;
+
+            char* p = cur_;
+
+            cur_ += stride_;
+            reinterpret_cast<batch_block**>(p)[-1] = this;
+
+            return p;
+        }
+
+        static void*
+        allocate_heap(size_t size, size_t align)
+        {
+            BOOST_ASSERT(align <= alignof(std::max_align_t));
+
+            size_t const offset = prefix(align);
+            char* const       p = static_cast<char*>(::operator new(offset + size)) + offset;
+
+            reinterpret_cast<std::uintptr_t*>(p)[-1] = offset | heap_tag; // Blocks are aligned: never tagged.
+
+            return p;
+        }
+
+        // Any thread. Whatever the type the allocation was made for.
+        static void
+        deallocate(void* p)
+        {
+            std::uintptr_t const prefix = reinterpret_cast<std::uintptr_t*>(p)[-1];
+
+            if (prefix & heap_tag) ::operator delete(static_cast<char*>(p) - (prefix & ~heap_tag));
+            else reinterpret_cast<batch_block*>(prefix)->release();
+        }
+
+        void release () { release_(1); }
+
+        // By the batch (when done). The unused slots and the batch itself.
+        void
+        close()
+        {
+            size_t const unused = (end_ - cur_) / stride_;
+
+            cur_ = end_;
+            release_(unused + 1);
+        }
+
+        private:
+
+        static constexpr std::uintptr_t heap_tag = 1;
+
+        void
+        release_(size_t num)
+        {
+            if (live_.fetch_sub(num, std::memory_order_acq_rel) == num)
+            {
+                this->~batch_block();
+                ::operator delete(this);
+            }
+        }
+
+        std::atomic<size_t> live_ { 0 }; // The slots (used or not yet) plus the batch itself.
+        size_t               size_;
+        size_t              align_;
+        size_t             stride_;
+        char*                 cur_; // Only advanced by the thread running the batch.
+        char*                 end_;
+    };
+
+    // Makes the block of 'count' implementations current for the duration of a batch.
+    // Nothing for the policies without batch allocators.
+    template<typename policy_type, typename impl_type, typename =void>
+    struct batch_scope
+    {
+        explicit batch_scope(size_t) {}
+    };
+
+    template<typename policy_type, typename impl_type>
+    struct batch_scope<policy_type, impl_type, typename std::conditional<true, void, typename policy_type::alloc_type::batched>::type>
+    {
+        batch_scope (batch_scope const&) =delete;
+       ~batch_scope ()
+        {
+            if (!block_) return;
+
+            batch_block::current() = previous_;
+            block_->close(); // The implementations keep the block.
+        }
+
+        explicit batch_scope(size_t count)
+        :
+            block_(count ? batch_block::make(count, sizeof(impl_type), alignof(impl_type)) : nullptr),
+            previous_(batch_block::current())
+        {
+            if (block_) batch_block::current() = block_;
+        }
+
+        private:
+
+        batch_block*    block_;
+        batch_block* previous_;
+    };
+}
+
+namespace impl_ptr_policy
+{
+    template<typename impl_type>
+    struct batch_allocator
+    {
+        using                             value_type = impl_type;
+        using                                batched = std::true_type;
+        using                        is_always_equal = std::true_type;
+        using propagate_on_container_move_assignment = std::true_type;
+
+        template<typename other_type> struct rebind { using other = batch_allocator<other_type>; };
+
+        batch_allocator () =default;
+
+        template<typename other_type>
+        batch_allocator (batch_allocator<other_type> const&) noexcept {}
+
+        impl_type*
+        allocate(size_t num)
+        {
+            static_assert(alignof(impl_type) <= alignof(std::max_align_t), "policy::batch does not support over-aligned implementations");
+
+            detail::batch_block* b = detail::batch_block::current();
+            void*                p = b ? b->allocate(num * sizeof(impl_type), alignof(impl_type)) : nullptr;
+
+            return static_cast<impl_type*>(p ? p : detail::batch_block::allocate_heap(num * sizeof(impl_type), alignof(impl_type)));
+        }
+        void deallocate (impl_type* p, size_t) noexcept { detail::batch_block::deallocate(p); }
+
+        template<typename other_type> bool operator==(batch_allocator<other_type> const&) const { return  true; }
+        template<typename other_type> bool operator!=(batch_allocator<other_type> const&) const { return false; }
+    };
+
+    template<typename impl_type, typename...>
+    using batch = unique<impl_type, batch_allocator<impl_type>>;
+
+    template<typename impl_type, typename...>
+    using copied_batch = copied<impl_type, batch_allocator<impl_type>>;
+}
+
+#endif // IMPL_PTR_DETAIL_BATCH_HPP
@@ -0,0 +1,249 @@
+// Copyright (c) 2008 Vladimir Batov.
+// Use, modification and distribution are subject to the Boost Software License,
+// Version 1.0. See http://www.boost.org/LICENSE_1_0.txt.
+
+#ifndef IMPL_PTR_DETAIL_BIASED_HPP
+#define IMPL_PTR_DETAIL_BIASED_HPP
+
+#include "./counted.hpp"
+#include <cstdint>
+
+// Biased reference counting for shared implementations mostly copied on the thread
+// creating them but occasionally shared with other threads (sessions, etc.).
+//
+//     struct Session : boost::impl_ptr<Session, policy::biased> { ... };
+//
+// 1) Shared semantics as policy::shared. The handle is one pointer.
+// 2) The count is biased towards the owner (constructing) thread. The owner updates
+//    its own count with plain loads and stores. Other threads update the shared atomic count.
+// 3) When the owner count drops to zero, the owner gives up the bias: it merges into
+//    the shared count (one atomic operation) and all later updates are atomic.
+//    The implementation is destroyed when the merged count drops to zero.
+// 4) A handle may be released on any thread, i.e. the shared count may go negative
+//    (the two counts only add up to the total). The first thread taking it negative
+//    queues the implementation to its owner. The owner merges its queue on its next
+//    construction, copy or release (of any biased implementation) or on exit. Then, an
+//    implementation only released by other threads may outlive its last handle until then
+//    (not longer than the owner's next use of the policy, e.g. a producer creating more).
+// 5) After the owner thread exits, queued implementations are merged by the releasing thread.
+// 6) Every thread creating biased implementations keeps a small never-destroyed record.
+
+namespace detail
+{
+    struct biased_counter;
+
+    // Per-thread record. Never destroyed: implementations may outlive their owner thread.
+    struct biased_owner
+    {
+        static biased_owner* current () { return current_(); }
+
+        static biased_owner*
+        local()
+        {
+            biased_owner*& owner = current_();
+
+            if (BOOST_UNLIKELY(!owner))
+            {
+                owner = new biased_owner();
+                cache(); // Closes the record on exit.
+            }
+            return owner;
+        }
+
+        bool pending () const { return queue_.load(std::memory_order_relaxed) != nullptr; }
+
+        inline void    push (biased_counter*); // Any thread.
+        inline void collect ();                // Owner thread only.
+
+        private:
+
+        struct thread_cache
+        {
+            // Releases on this thread from now on (e.g. by the destructors run by close()) are not biased.
+           ~thread_cache() { biased_owner* o = current_(); current_() = nullptr; if (o) o->close(); }
+        };
+
+        // The plain pointer (no guard, no destructor) is for the fast path.
+        static biased_owner*& current_ () { static thread_local biased_owner* owner = nullptr; return owner; }
+        static thread_cache&     cache () { static thread_local thread_cache local; return local; }
+        static biased_counter* closed () { return reinterpret_cast<biased_counter*>(std::uintptr_t(1)); }
+
+        inline void close ();
+
+        std::atomic<biased_counter*> queue_ { nullptr };
+    };
+
+    struct biased_counter
+    {
+        explicit biased_counter(long n) : owner_(biased_owner::local()), origin_(owner_.load(std::memory_order_relaxed)), biased_(n)
+        {
+            collect_(origin_); // A producer thread (only creating) reclaims its released implementations too.
+        }
+
+        void
+        add()
+        {
+            collect_(biased_owner::current());
+
+            if (owned_())
+                biased_.store(biased_.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+            else
+                shared_.fetch_add(one, std::memory_order_relaxed);
+        }
+
+        // True when the last reference is released.
+        bool
+        release()
+        {
+            biased_owner* me = biased_owner::current();
+
+            collect_(me);
+
+            if (me && owner_.load(std::memory_order_relaxed) == me)
+            {
+                long const biased = biased_.load(std::memory_order_relaxed) - 1;
+
+                biased_.store(biased, std::memory_order_relaxed);
+
+                if (biased)
+                    return false;
+
+                // Merge. All later updates (on any thread) are to the shared count.
+                owner_.store(nullptr, std::memory_order_relaxed);
+
+                return shared_.fetch_add(merged, std::memory_order_acq_rel) + merged == merged;
+            }
+
+            long const state = shared_.fetch_sub(one, std::memory_order_acq_rel) - one;
+
+            if (state & merged)
+                return state == merged;
+
+            if (count_(state) < 0 && !(state & queued))
+                enqueue_();
+
+            return false;
+        }
+
+        // Approximate when used concurrently (as std::shared_ptr::use_count()).
+        long
+        count() const
+        {
+            return biased_.load(std::memory_order_relaxed) + count_(shared_.load(std::memory_order_acquire));
+        }
+
+        private:
+
+        friend struct biased_owner;
+
+        using header_type = counted_header<biased_counter>;
+
+        // The shared state is (count * 4 + queued * 2 + merged) to update all at once.
+        // The implementation is destroyed by the update leaving the state 'merged' exactly.
+        static long constexpr merged = 1;
+        static long constexpr queued = 2;
+        static long constexpr    one = 4;
+
+        static long count_ (long state) { return (state - (state & (merged | queued))) / one; }
+
+        // The implementations released by other threads and queued to this one (if any).
+        static void collect_ (biased_owner* me) { if (me && BOOST_UNLIKELY(me->pending())) me->collect(); }
+
+        bool
+        owned_() const
+        {
+            biased_owner* me = biased_owner::current();
+
+            return me && owner_.load(std::memory_order_relaxed) == me;
+        }
+
+        void
+        enqueue_()
+        {
+            long const state = shared_.fetch_or(queued, std::memory_order_acq_rel);
+
+            /**/ if (state & queued);                // Queued by another thread.
+            else if (state & merged) unqueue_(0);    // Merged meanwhile.
+            else origin_->push(this);
+        }
+
+        // By the owner thread (or any thread after the owner exits). The counter is queued.
+        void
+        merge_()
+        {
+            long add = 0;
+
+            if (owner_.load(std::memory_order_relaxed))
+            {
+                add = biased_.load(std::memory_order_relaxed) * one + merged;
+
+                biased_.store(0, std::memory_order_relaxed);
+                owner_.store(nullptr, std::memory_order_relaxed);
+            }
+            unqueue_(add);
+        }
+        void
+        unqueue_(long add)
+        {
+            if (shared_.fetch_add(add - queued, std::memory_order_acq_rel) + add - queued == merged)
+            {
+                header_type* h = reinterpret_cast<header_type*>(this); // The counter is the first header member.
+
+                h->ops->destroy(h);
+            }
+        }
+
+        std::atomic<biased_owner*>      owner_; // Null once merged.
+        biased_owner* const            origin_;
+        std::atomic<long>              biased_; // Updated by the owner thread only. Atomic for count().
+        std::atomic<long>              shared_ { 0 };
+        biased_counter*                  next_ = nullptr; // In the owner queue.
+    };
+
+    inline void
+    biased_owner::push(biased_counter* c)
+    {
+        biased_counter* head = queue_.load(std::memory_order_acquire);
+
+        do
+        {
+            if (head == closed())
+                return c->merge_(); // The owner thread has exited. Nothing else updates the owner count.
+
+            c->next_ = head;
+        }
+        while (!queue_.compare_exchange_weak(head, c, std::memory_order_acq_rel, std::memory_order_acquire));
+    }
+
+    inline void
+    biased_owner::collect()
+    {
+        for (biased_counter* c = queue_.exchange(nullptr, std::memory_order_acq_rel); c;)
+        {
+            biased_counter* next = c->next_; // 'c' may be destroyed by the merge.
+
+            c->merge_();
+            c = next;
+        }
+    }
+
+    inline void
+    biased_owner::close()
+    {
+        for (biased_counter* c = queue_.exchange(closed(), std::memory_order_acq_rel); c;)
+        {
+            biased_counter* next = c->next_;
+
+            c->merge_();
+            c = next;
+        }
+    }
+}
+
+namespace impl_ptr_policy
+{
+    template<typename impl_type, typename allocator =std::allocator<void>>
+    using biased = detail::counted_shared<impl_type, detail::biased_counter, allocator>;
+}
+
+#endif // IMPL_PTR_DETAIL_BIASED_HPP
@@ -0,0 +1,256 @@
+// Copyright (c) 2008 Vladimir Batov.
+// Use, modification and distribution are subject to the Boost Software License,
+// Version 1.0. See http://www.boost.org/LICENSE_1_0.txt.
+
+#ifndef IMPL_PTR_DETAIL_COUNTED_HPP
+#define IMPL_PTR_DETAIL_COUNTED_HPP
+
+#include "./detail.hpp"
+#include <atomic>
+#include <cstddef>
+#include <new>
+#ifndef NDEBUG
+#include <thread>
+#endif
+
+// Reference-counted implementations co-allocated with their counter.
+//
+//     [ header: counter | ops ][ implementation ]
+//                               ^
+//                               handle
+//
+// 1) The handle is one pointer to the implementation. The header is at a fixed offset
+//    before it. Then, get() is a plain load and the handle is trivially relocatable.
+// 2) The header points to the operations of the type actually constructed (possibly
+//    derived from impl_type). Then, destruction, deallocation and cloning are correct
+//    for derived implementations without a virtual destructor or size bookkeeping.
+// 3) The counter type (atomic, thread-local, etc.) is a parameter.
+// 4) Implementations must not be over-aligned and must be at the same address as
+//    their impl_type base (single, non-virtual inheritance).
+
+namespace detail
+{
+    // Thread-safe counter (as std::shared_ptr).
+    struct atomic_counter
+    {
+        explicit atomic_counter(long n) : count_(n) {}
+
+        void    add () { count_.fetch_add(1, std::memory_order_relaxed); }
+        long  count () const { return count_.load(std::memory_order_acquire); }
+
+        // True when the last reference is released.
+        bool
+        release()
+        {
+            if (count_.fetch_sub(1, std::memory_order_release) != 1)
+                return false;
+
+            std::atomic_thread_fence(std::memory_order_acquire);
+            return true;
+        }
+
+        private: std::atomic<long> count_;
+    };
+
+    // Single-threaded counter (as boost::local_shared_ptr). In debug builds, the use
+    // from a thread other than the constructing one is detected.
+    struct local_counter
+    {
+        explicit local_counter(long n) : count_(n) {}
+
+        void       add () { check_(); ++count_; }
+        long     count () const { check_(); return count_; }
+        bool   release () { check_(); return --count_ == 0; }
+
+        private:
+
+#ifndef NDEBUG
+        void check_ () const { BOOST_ASSERT_MSG(owner_ == std::this_thread::get_id(), "Cross-thread use of a local counter"); }
+
+        std::thread::id owner_ = std::this_thread::get_id();
+#else
+        void check_ () const {}
+#endif
+        long count_;
+    };
+
+    template<typename counter_type>
+    struct counted_header
+    {
+        struct ops_type
+        {
+            void            (*destroy) (counted_header*);
+            counted_header* (*clone)   (counted_header const*); // nullptr for non-copyable implementations
+        };
+
+        static size_t constexpr size = (sizeof(counter_type) + sizeof(ops_type const*) + alignof(std::max_align_t) - 1)
+                                     / alignof(std::max_align_t) * alignof(std::max_align_t);
+
+        counted_header(ops_type const* o) : count(1), ops(o) {}
+
+        void* value () { return reinterpret_cast<char*>(this) + size; }
+
+        static counted_header* from (void const* v) { return reinterpret_cast<counted_header*>(static_cast<char*>(const_cast<void*>(v)) - size); }
+
+        counter_type        count;
+        ops_type const*       ops;
+    };
+
+    template<typename impl_type, typename counter_type, typename allocator>
+    struct counted_ptr
+    {
+        using   this_type = counted_ptr;
+        using header_type = counted_header<counter_type>;
+        using    ops_type = typename header_type::ops_type;
+        struct alignas(std::max_align_t) unit { char bytes[alignof(std::max_align_t)]; };
+        using  alloc_type = typename std::allocator_traits<allocator>::template rebind_alloc<unit>;
+        using alloc_traits = std::allocator_traits<alloc_type>;
+
+       ~counted_ptr () { reset(); }
+        counted_ptr () =default;
+        counted_ptr (this_type const& o) : impl_(o.impl_) { if (impl_) header()->count.add(); }
+        counted_ptr (this_type&& o) noexcept : impl_(o.impl_) { o.impl_ = nullptr; }
+
+        this_type& operator=(this_type const& o) { this_type(o).swap(*this); return *this; }
+        this_type& operator=(this_type&& o) noexcept { this_type(std::move(o)).swap(*this); return *this; }
+
+        template<typename derived_type, typename... arg_types>
+        static this_type
+        make(arg_types&&... args)
+        {
+            static_assert(alignof(derived_type) <= alignof(std::max_align_t), "Over-aligned implementations are not supported");
+
+            alloc_type       a;
+            size_t const     n = units<derived_type>();
+            unit* const  block = alloc_traits::allocate(a, n);
+            header_type*     h = ::new (block) header_type(ops<derived_type>::table());
+
+            try
+            {
+                derived_type* d = ::new (h->value()) derived_type(std::forward<arg_types>(args)...);
+                this_type     p;
+
+                p.impl_ = d;
+                BOOST_ASSERT((void*) p.impl_ == (void*) d); // impl_type is at the start of derived_type.
+
+                return p;
+            }
+            catch (...)
+            {
+                h->~header_type();
+                alloc_traits::deallocate(a, block, n);
+                throw;
+            }
+        }
+
+        // A copy of the implementation (of its most derived type) in a new block.
+        this_type
+        clone() const
+        {
+            BOOST_ASSERT(impl_ && header()->ops->clone);
+
+            this_type p;
+
+            p.impl_ = static_cast<impl_type*>(header()->ops->clone(header())->value());
+            return p;
+        }
+
+        void
+        reset()
+        {
+            if (impl_ && header()->count.release())
+                header()->ops->destroy(header());
+
+            impl_ = nullptr;
+        }
+
+        void       swap (this_type& o) noexcept { std::swap(impl_, o.impl_); }
+        impl_type*  get () const { return impl_; }
+        long  use_count () const { return impl_ ? header()->count.count() : 0; }
+        bool     unique () const { return use_count() == 1; }
+
+        header_type* header () const { return header_type::from(impl_); }
+
+        private:
+
+        template<typename derived_type>
+        static constexpr size_t units() { return (header_type::size + sizeof(derived_type) + sizeof(unit) - 1) / sizeof(unit); }
+
+        template<typename derived_type>
+        static void
+        destroy(header_type* h)
+        {
+            alloc_type a;
+
+            static_cast<derived_type*>(h->value())->~derived_type();
+            h->~header_type();
+            alloc_traits::deallocate(a, reinterpret_cast<unit*>(h), units<derived_type>());
+        }
+        template<typename derived_type>
+        static header_type*
+        clone(header_type const* h)
+        {
+            derived_type const& from = *static_cast<derived_type const*>(const_cast<header_type*>(h)->value());
+
+            return header_type::from(make<derived_type>(from).release_());
+        }
+
+        // One constant (no guard) table per constructed type.
+        template<typename derived_type, bool =std::is_copy_constructible<derived_type>::value>
+        struct ops
+        {
+            static ops_type const* table() { static constexpr ops_type t = { &destroy<derived_type>, &clone<derived_type> }; return &t; }
+        };
+        template<typename derived_type>
+        struct ops<derived_type, false>
+        {
+            static ops_type const* table() { static constexpr ops_type t = { &destroy<derived_type>, nullptr }; return &t; }
+        };
+
+        impl_type* release_ () { impl_type* p = impl_; impl_ = nullptr; return p; }
+
+        impl_type* impl_ = nullptr;
+    };
+}
+
+namespace detail
+{
+    template<typename, typename, typename> struct counted_shared;
+}
+
+// Shared semantics over a counted_ptr with the given counter (policy::local_shared, intrusive, biased).
+template<typename impl_type, typename counter_type, typename allocator>
+struct detail::counted_shared
+{
+    using  this_type = counted_shared;
+    using   ptr_type = counted_ptr<impl_type, counter_type, allocator>;
+
+    using trivially_relocatable = std::true_type;
+
+    counted_shared (std::nullptr_t) {}
+
+    template<typename... arg_types>
+    counted_shared (detail::in_place_type, arg_types&&... args)
+    {
+        emplace<impl_type>(std::forward<arg_types>(args)...);
+    }
+
+    template<typename derived_type, typename... arg_types>
+    void
+    emplace(arg_types&&... args)
+    {
+        impl_ = ptr_type::template make<derived_type>(std::forward<arg_types>(args)...);
+    }
+
+    bool operator==(this_type const& o) const { return impl_.get() == o.impl_.get(); }
+    bool operator!=(this_type const& o) const { return impl_.get() != o.impl_.get(); }
+    bool operator< (this_type const& o) const { return impl_.get()  < o.impl_.get(); }
+    void      swap (this_type& o) noexcept { impl_.swap(o.impl_); }
+
+    impl_type*       get () const { return impl_.get(); }
+    long       use_count () const { return impl_.use_count(); }
+
+    private: ptr_type impl_;
+};
+
+#endif // IMPL_PTR_DETAIL_COUNTED_HPP
@@ -0,0 +1,71 @@
+// Copyright (c) 2008 Vladimir Batov.
+// Use, modification and distribution are subject to the Boost Software License,
+// Version 1.0. See http://www.boost.org/LICENSE_1_0.txt.
+
+#ifndef IMPL_PTR_DETAIL_COW_HPP
+#define IMPL_PTR_DETAIL_COW_HPP
+
+#include "./counted.hpp"
+
+// Copy-on-write value semantics.
+//
+//     struct Config : boost::impl_ptr<Config, policy::cow> { ... };
+//
+//     string Config::name () const { return (*this)->name; } // Const access. Shared.
+//     void   Config::name (string const& n) { (*this)->name = n; } // Non-const access. Detached first.
+//
+// 1) A copy shares the implementation (O(1)). The implementation is cloned (of its
+//    most-derived type) on the first non-const access through a shared handle, or on detach().
+// 2) Const access yields 'impl_type const*'. Then, a const member function cannot
+//    modify a shared implementation by mistake.
+// 3) The unique ownership is detected with an atomic counter. Then, copies of one
+//    implementation can be used and modified from different threads.
+// 4) The handle is one pointer. The counter is co-allocated with the implementation.
+
+namespace impl_ptr_policy
+{
+    template<typename, typename =std::allocator<void>> struct cow;
+}
+
+template<typename impl_type, typename allocator>
+struct impl_ptr_policy::cow
+{
+    using  this_type = cow;
+    using   ptr_type = detail::counted_ptr<impl_type, detail::atomic_counter, allocator>;
+
+    using trivially_relocatable = std::true_type;
+
+    cow (std::nullptr_t) {}
+
+    template<typename... arg_types>
+    cow (detail::in_place_type, arg_types&&... args)
+    {
+        emplace<impl_type>(std::forward<arg_types>(args)...);
+    }
+
+    template<typename derived_type, typename... arg_types>
+    void
+    emplace(arg_types&&... args)
+    {
+        impl_ = ptr_type::template make<derived_type>(std::forward<arg_types>(args)...);
+    }
+
+    // Makes sure the implementation is not shared.
+    void
+    detach()
+    {
+        if (impl_.get() && !impl_.unique())
+            impl_ = impl_.clone();
+    }
+
+    bool operator< (this_type const& o) const { return impl_.get() < o.impl_.get(); }
+    void      swap (this_type& o) noexcept { impl_.swap(o.impl_); }
+
+    impl_type const*         get () const { return impl_.get(); }
+    impl_type*       get_mutable ()       { detach(); return impl_.get(); }
+    long               use_count () const { return impl_.use_count(); }
+
+    private: ptr_type impl_;
+};
+
+#endif // IMPL_PTR_DETAIL_COW_HPP
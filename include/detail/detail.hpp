@@ -8,6 +8,8 @@
 
 #include <boost/type_traits.hpp>
 #include <boost/assert.hpp>
+#include <boost/core/empty_value.hpp>
+#include <atomic>
 #include <type_traits>
 #include <memory>
 
@@ -38,7 +40,7 @@ namespace detail
     };
 
     // The incomplete-type management technique
-    // is originally by Peter Dimov.
+    // is originally by Peter Dimov. Here, with a table of functions instead of virtuals.
     struct traits
     {
         template<typename, typename, typename> struct base;
@@ -47,6 +49,51 @@ namespace detail
         template<typename, typename> struct copyable;
     };
 
+    // Allocator propagation as std containers do it: the allocator follows the
+    // assigned/swapped content only if propagate_on_container_xxx says so.
+    // Otherwise, it is left untouched (and is not required to be assignable).
+    template<typename AT> void propagate_allocator(AT& to, AT const& from, std::true_type) { to = from; }
+    template<typename AT> void propagate_allocator(AT&,    AT const&,      std::false_type) {}
+    template<typename AT> void      swap_allocator(AT& a1, AT& a2, std::true_type) { using std::swap; swap(a1, a2); }
+    template<typename AT> void      swap_allocator(AT&,    AT&,    std::false_type) {}
+
+    // A handle holding a pointer and an allocator can be relocated with memcpy
+    // (see boost::is_trivially_relocatable) if its allocator can.
+    template<typename AT>
+    using relocatable_allocator = std::integral_constant<bool, std::is_empty<AT>::value || std::is_trivially_copyable<AT>::value>;
+
+    // Allocators that release their memory in bulk (e.g. regions) may opt out of
+    // per-object destruction with 'using skips_destruction = std::true_type;'.
+    // Then, destroying a handle is a no-op. Only allowed for trivially destructible types.
+    template<typename, typename =void>
+    struct skips_destruction : std::false_type {};
+
+    template<typename AT>
+    struct skips_destruction<AT, typename std::conditional<true, void, typename AT::skips_destruction>::type>
+    :
+        AT::skips_destruction
+    {};
+
+    // Non-const access to the implementation. Policies with copy-on-write provide get_mutable().
+    template<typename PT> auto get_mutable_(PT& p, int) -> decltype(p.get_mutable()) { return p.get_mutable(); }
+    template<typename PT> auto get_mutable_(PT& p, ...) -> decltype(p.get())         { return p.get(); }
+    template<typename PT> auto get_mutable (PT& p)      -> decltype(get_mutable_(p, 0)) { return get_mutable_(p, 0); }
+
+    // Null check. Policies constructing on access (lazy) provide is_null().
+    template<typename PT> auto is_null_(PT const& p, int) -> decltype(p.is_null()) { return p.is_null(); }
+    template<typename PT> bool is_null_(PT const& p, ...) { return !p.get(); }
+    template<typename PT> bool is_null (PT const& p) { return is_null_(p, 0); }
+
+    // Whether 'option' is among the (tag) options passed to a policy.
+    template<typename, typename...>
+    struct has_option : std::false_type {};
+
+    template<typename option, typename... more>
+    struct has_option<option, option, more...> : std::true_type {};
+
+    template<typename option, typename other, typename... more>
+    struct has_option<option, other, more...> : has_option<option, more...> {};
+
     // Helper class to ensure memory gets deallocated regardless of whether construction/destruction throws
     template<typename AT>
     struct dealloc_guard
@@ -90,14 +137,35 @@ struct detail::traits::base
     struct deleter;
     using     ptr_type = std::unique_ptr<impl_type, deleter>;
 
-    struct deleter
+    // The deleter carries the allocator instance the implementation was allocated with.
+    // A stateless allocator takes no space (EBO), i.e. ptr_type stays the size of a pointer.
+    struct deleter : boost::empty_value<alloc_type>
     {
         // type used by unique_ptr as replacement for T*
         using pointer = base::pointer;
-        void operator()(pointer ip) const { base::destroy(ip); }
+        using  base_type = boost::empty_value<alloc_type>;
+
+        deleter () =default;
+        deleter (alloc_type const& a) : base_type(boost::empty_init_t(), a) {}
+
+        alloc_type&       allocator ()       { return base_type::get(); }
+        alloc_type const& allocator () const { return base_type::get(); }
+
+        void operator()(pointer ip) { destroy(ip, skips_destruction<alloc_type>()); }
+
+        private:
+
+        void destroy(pointer ip, std::false_type) { base::destroy(allocator(), ip); }
+        void destroy(pointer,    std::true_type ) {}
     };
 
-    virtual ~base() =default;
+    // The operations needing the complete implementation type are in traits_type::table.
+    // One constant table per traits type with only the operations of its policy, built at
+    // compile time where the implementation is visible (the table is only instantiated
+    // from emplace()). emplace() publishes the table with a relaxed store, only while it is not
+    // published yet (a relaxed load otherwise). Then, the pointer read by destroy() etc. is
+    // not written on the hot path. No guard, no synchronization beyond the one that hands
+    // the constructed object over to other threads.
 
     template<typename derived_type, typename... arg_types>
     static void emplace(
@@ -110,82 +178,115 @@ struct detail::traits::base
     {
         using alloc_traits = typename alloc_traits::template rebind_traits<typename std::remove_cv<derived_type>::type>;
 
-        construct_singleton();
+        publish_table();
         alloc_traits::construct(alloc, p, std::forward<arg_types>(args)...);
     }
 
     template<typename derived_type, typename... arg_types>
-    static ptr_type make(detail::in_place_type, arg_types&&... args)
+    static ptr_type make(alloc_type const& alloc, detail::in_place_type, arg_types&&... args)
     {
         using    alloc_type = typename alloc_traits::template rebind_alloc<derived_type>;
         using  alloc_traits = std::allocator_traits<alloc_type>;
         using dealloc_guard = detail::dealloc_guard<alloc_type>;
 
-        alloc_type     a;
-        dealloc_guard ap(a, alloc_traits::allocate(a, 1));
+        static_assert(!skips_destruction<alloc_type>::value || std::is_trivially_destructible<derived_type>::value,
+                "Destruction may only be skipped for trivially destructible implementations");
+
+        alloc_type     a (alloc);
+        dealloc_guard ap (a, alloc_traits::allocate(a, 1));
 
         emplace(a, ap.get(), std::forward<arg_types>(args)...);
-        return ptr_type(ap.release());
+        return ptr_type(ap.release(), deleter(alloc));
     }
 
-    static void       destroy (pointer p                       ) { return traits_->do_destroy  (p                 ); }
-    static void        assign (pointer p, impl_type const& from) { return traits_->do_assign   (p,           from ); }
-    static void        assign (pointer p, impl_type     && from) { return traits_->do_assign   (p, std::move(from)); }
-    static void     construct (void*   p, impl_type const& from) { return traits_->do_construct(p,           from ); }
-    static void     construct (void*   p, impl_type     && from) { return traits_->do_construct(p, std::move(from)); }
-    static ptr_type      make (           impl_type const& from) { return traits_->do_make     (             from ); }
-    static ptr_type      make (           impl_type     && from) { return traits_->do_make     (   std::move(from)); }
+    static void destroy (alloc_type& a, pointer p) { return table_()->destroy(a, p); }
 
     protected:
 
-    void destroy_(pointer p) const
+    static void destroy_(alloc_type& a, pointer p)
     {
-        alloc_type a;
         dealloc_guard<alloc_type> ap(a, std::move(p));
         alloc_traits::destroy(a, ap.get());
     }
 
-    private:
+    static auto table_()
+    {
+        auto t = static_cast<typename traits_type::table const*>(table_ptr_.load(std::memory_order_relaxed));
+
+        BOOST_ASSERT(t); // An implementation has been constructed.
+        return t;
+    }
 
-    virtual void       do_destroy (pointer) const =0;
-    virtual void        do_assign (pointer, impl_type const&) const =0;
-    virtual void        do_assign (pointer, impl_type&&) const =0;
-    virtual void     do_construct (void*, impl_type const&) const =0;
-    virtual void     do_construct (void*, impl_type&& ) const =0;
-    virtual ptr_type      do_make (impl_type const&) const =0;
-    virtual ptr_type      do_make (impl_type&& ) const =0;
+    private:
 
-    static void construct_singleton()
+    static void publish_table()
     {
         static_assert(!std::is_same<this_type, traits_type>::value, "");
         static_assert(std::is_base_of<this_type, traits_type>::value, "");
 
-        static traits_type const traits = ((traits_ = &traits), traits_type{});
+        if (BOOST_UNLIKELY(!table_ptr_.load(std::memory_order_relaxed)))
+            table_ptr_.store(&traits_type::operations, std::memory_order_relaxed);
     }
-    private: static base const* traits_;
+    static std::atomic<void const*> table_ptr_; // Constant-initialized.
 };
 
 template<typename traits_type, typename impl_type, typename alloc_type>
-detail::traits::base<traits_type, impl_type, alloc_type> const*
-detail::traits::base<traits_type, impl_type, alloc_type>::traits_;
+std::atomic<void const*>
+detail::traits::base<traits_type, impl_type, alloc_type>::table_ptr_ { nullptr };
 
 template<typename impl_type, typename allocator>
 struct detail::traits::unique final : base<unique<impl_type, allocator>, impl_type, allocator>
 {
-    using this_type = unique<impl_type, allocator>;
-    using base_type = base<this_type, impl_type, allocator>;
-    using   pointer = typename base_type::pointer;
-    using  ptr_type = typename base_type::ptr_type;
-
-    void       do_destroy (pointer p                  ) const override { this->destroy_(p); }
-    void        do_assign (pointer  , impl_type const&) const override { BOOST_ASSERT(!"not implemented"); }
-    void        do_assign (pointer  , impl_type&&     ) const override { BOOST_ASSERT(!"not implemented"); }
-    void     do_construct (void*    , impl_type const&) const override { BOOST_ASSERT(!"not implemented"); }
-    void     do_construct (void*    , impl_type&&     ) const override { BOOST_ASSERT(!"not implemented"); }
-    ptr_type      do_make (           impl_type const&) const override { BOOST_ASSERT(!"not implemented"); return nullptr; }
-    ptr_type      do_make (           impl_type&&     ) const override { BOOST_ASSERT(!"not implemented"); return nullptr; }
+    using  this_type = unique<impl_type, allocator>;
+    using  base_type = base<this_type, impl_type, allocator>;
+    using alloc_type = typename base_type::alloc_type;
+    using    pointer = typename base_type::pointer;
+    using   ptr_type = typename base_type::ptr_type;
+
+    using alloc_traits = typename base_type::alloc_traits;
+    using      make_fn = ptr_type (*)(alloc_type const&, impl_type&&);
+
+    // Non-copyable. Besides destruction, only moved into a new allocation: across
+    // non-propagating unequal allocators (e.g. pmr), where the pointer cannot change hands.
+    struct table
+    {
+        void (*destroy)   (alloc_type&, pointer);
+        make_fn move_make;
+    };
+
+    static ptr_type make (alloc_type const& a, impl_type&& from) { BOOST_ASSERT(base_type::table_()->move_make); return base_type::table_()->move_make(a, std::move(from)); }
+
+    using base_type::make; // make<derived_type>(alloc, in_place, args...)
+
+    private:
+
+    friend base_type;
+
+    using moves_values = std::integral_constant<bool,
+        !alloc_traits::is_always_equal::value &&
+        !(alloc_traits::propagate_on_container_move_assignment::value && alloc_traits::propagate_on_container_swap::value)>;
+
+    static ptr_type
+    do_make(alloc_type const& a, impl_type&& from)
+    {
+        return base_type::template make<impl_type>(a, in_place_type(), std::move(from));
+    }
+    static constexpr make_fn
+    move_make_(std::true_type)
+    {
+        static_assert(std::is_move_constructible<impl_type>::value,
+                "Unique implementations with non-propagating stateful allocators must be move-constructible");
+        return &do_make;
+    }
+    static constexpr make_fn move_make_ (std::false_type) { return nullptr; } // Movable or not.
+
+    static constexpr table operations = { &base_type::destroy_, move_make_(moves_values()) };
 };
 
+template<typename impl_type, typename allocator>
+constexpr typename detail::traits::unique<impl_type, allocator>::table
+detail::traits::unique<impl_type, allocator>::operations;
+
 template<typename impl_type, typename allocator>
 struct detail::traits::copyable final : base<copyable<impl_type, allocator>, impl_type, allocator>
 {
@@ -196,40 +297,71 @@ struct detail::traits::copyable final : base<copyable<impl_type, allocator>, imp
     using      pointer = typename base_type::pointer;
     using     ptr_type = typename base_type::ptr_type;
 
-    void do_destroy(pointer p) const override { this->destroy_(p); }
-
-    void
-    do_construct(void* vp, impl_type const& from) const override
+    struct table
     {
-        alloc_type a;
-        this->emplace(a, static_cast<impl_type*>(vp), from);
-    }
-    void
-    do_construct(void* vp, impl_type&& from) const override
+        void     (*destroy)        (alloc_type&, pointer);
+        void     (*copy_assign)    (pointer, impl_type const&);
+        void     (*move_assign)    (pointer, impl_type&&);
+        void     (*copy_construct) (alloc_type&, void*, impl_type const&);
+        void     (*move_construct) (alloc_type&, void*, impl_type&&);
+        ptr_type (*copy_make)      (alloc_type const&, impl_type const&);
+        ptr_type (*move_make)      (alloc_type const&, impl_type&&);
+        bool       trivial;        // Copyable with memcpy, destructible by doing nothing.
+    };
+
+    static void       assign (               pointer p, impl_type const& from) { return base_type::table_()->copy_assign   (   p,           from ); }
+    static void       assign (               pointer p, impl_type     && from) { return base_type::table_()->move_assign   (   p, std::move(from)); }
+    static void    construct (alloc_type& a, void*   p, impl_type const& from) { return base_type::table_()->copy_construct(a, p,           from ); }
+    static void    construct (alloc_type& a, void*   p, impl_type     && from) { return base_type::table_()->move_construct(a, p, std::move(from)); }
+    static ptr_type     make (alloc_type const& a,      impl_type const& from) { return base_type::table_()->copy_make     (a,              from ); }
+    static ptr_type     make (alloc_type const& a,      impl_type     && from) { return base_type::table_()->move_make     (a,    std::move(from)); }
+
+    using base_type::make; // make<derived_type>(alloc, in_place, args...)
+
+    static bool trivial () { return base_type::table_()->trivial; }
+
+    private:
+
+    friend base_type;
+
+    static void
+    do_construct(alloc_type& a, void* vp, impl_type const& from)
     {
-        alloc_type a;
-        this->emplace(a, static_cast<impl_type*>(vp), std::move(from));
+        base_type::emplace(a, static_cast<impl_type*>(vp), from);
     }
-    ptr_type
-    do_make(impl_type const& from) const override
+    static void
+    do_construct(alloc_type& a, void* vp, impl_type&& from)
     {
-        return this->template make<impl_type>(in_place_type(), from);
+        base_type::emplace(a, static_cast<impl_type*>(vp), std::move(from));
     }
-    ptr_type
-    do_make(impl_type&& from) const override
+    static ptr_type
+    do_make(alloc_type const& a, impl_type const& from)
     {
-        return this->template make<impl_type>(in_place_type(), std::move(from));
+        return base_type::template make<impl_type>(a, in_place_type(), from);
     }
-    void
-    do_assign(pointer p, impl_type const& from) const override
+    static ptr_type
+    do_make(alloc_type const& a, impl_type&& from)
     {
-        *p = from;
+        return base_type::template make<impl_type>(a, in_place_type(), std::move(from));
     }
-    void
-    do_assign(pointer p, impl_type&& from) const override
+    static void do_assign (pointer p, impl_type const& from) { *p = from; }
+    static void do_assign (pointer p, impl_type&&      from) { *p = std::move(from); }
+
+    static constexpr table operations =
     {
-        *p = std::move(from);
-    }
+        &base_type::destroy_,
+        &do_assign,
+        &do_assign,
+        &do_construct,
+        &do_construct,
+        &do_make,
+        &do_make,
+        std::is_trivially_copyable<impl_type>::value && std::is_trivially_destructible<impl_type>::value
+    };
 };
 
+template<typename impl_type, typename allocator>
+constexpr typename detail::traits::copyable<impl_type, allocator>::table
+detail::traits::copyable<impl_type, allocator>::operations;
+
 #endif // IMPL_PTR_DETAIL_DETAIL_HPP
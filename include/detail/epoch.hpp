@@ -0,0 +1,257 @@
+// Copyright (c) 2008 Vladimir Batov.
+// Use, modification and distribution are subject to the Boost Software License,
+// Version 1.0. See http://www.boost.org/LICENSE_1_0.txt.
+
+#ifndef IMPL_PTR_DETAIL_EPOCH_HPP
+#define IMPL_PTR_DETAIL_EPOCH_HPP
+
+#include "./detail.hpp"
+#include <boost/align/aligned_alloc.hpp>
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <new>
+#include <vector>
+
+// Atomic handles to shared implementations swapped at run-time (configurations, routing
+// tables, etc.) with epoch-based reclamation.
+//
+//     static boost::impl_ptr_atomic<Config> config (Config(args));
+//
+//     config.snapshot()->timeout();  // Reader. No reference count update, no lock.
+//     config.store(Config(new_args)); // Writer.
+//
+// 1) The atomic holds a pointer to a (heap) copy of the user handle. Replaced copies are
+//    retired and destroyed once no reader can still see them.
+// 2) A reader announces the global epoch in its own (per-thread, cache-line) record, takes
+//    a full fence and loads the pointer. No shared cache line is written. Nested snapshots
+//    on the same thread only increment a thread-local depth.
+// 3) A writer (under one global mutex, writers are expected to be rare) advances the global
+//    epoch when all active readers have announced the current one. A handle retired at
+//    epoch 'e' is destroyed when the global epoch reaches 'e + 2'.
+// 4) A snapshot must not outlive the impl_ptr_atomic. Long-held values are to be load()-ed
+//    (a copy of the handle) instead.
+// 5) Per-thread records are reused by later threads and never returned to the system.
+
+namespace detail
+{
+    struct epoch_domain
+    {
+        struct alignas(64) record // One cache line per reader thread.
+        {
+            std::atomic<uint64_t>  epoch { 0 }; // Zero when not reading.
+            std::atomic<bool>     in_use { true };
+            unsigned               depth = 0;   // Owner thread only.
+            record*                 next = nullptr;
+        };
+
+        static epoch_domain& instance() { static epoch_domain& single = *new epoch_domain(); return single; } // Never destroyed.
+
+        static record*
+        local()
+        {
+            record*& r = current_();
+
+            if (BOOST_UNLIKELY(!r))
+            {
+                r = instance().acquire_();
+                cache(); // Releases the record on exit.
+            }
+            return r;
+        }
+
+        void
+        enter(record* r)
+        {
+            if (r->depth++) return;
+
+            r->epoch.store(global_.load(std::memory_order_relaxed), std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_seq_cst); // The announcement before the loads.
+        }
+        void
+        leave(record* r)
+        {
+            if (--r->depth) return;
+
+            r->epoch.store(0, std::memory_order_release);
+        }
+
+        // Any thread. Destroys 'p' when no reader can see it.
+        void
+        retire(void* p, void (*destroy)(void*))
+        {
+            std::vector<retired> ready;
+            {
+                std::lock_guard<std::mutex> lock (mutex_);
+
+                retired_.push_back(retired { p, destroy, global_.load(std::memory_order_relaxed) });
+
+                for (int k = 0; k < 2 && try_advance_(); ++k); // Both at once when there are no readers.
+
+                uint64_t const global = global_.load(std::memory_order_relaxed);
+                auto           unseen = std::stable_partition(retired_.begin(), retired_.end(), [=](retired const& r){ return global < r.epoch + 2; });
+
+                ready.assign(unseen, retired_.end());
+                retired_.erase(unseen, retired_.end());
+            }
+            for (retired const& r : ready) // Outside the lock.
+                r.destroy(r.p);
+        }
+
+        private:
+
+        struct retired
+        {
+            void*                p;
+            void   (*destroy)(void*);
+            uint64_t         epoch;
+        };
+
+        struct thread_cache
+        {
+           ~thread_cache() { if (record* r = current_()) r->in_use.store(false, std::memory_order_release); current_() = nullptr; }
+        };
+
+        static record*&   current_ () { static thread_local record* r = nullptr; return r; }
+        static thread_cache& cache () { static thread_local thread_cache local; return local; }
+
+        record*
+        acquire_()
+        {
+            for (record* r = records_.load(std::memory_order_acquire); r; r = r->next)
+            {
+                bool free = false;
+
+                if (r->in_use.compare_exchange_strong(free, true, std::memory_order_acq_rel))
+                    return r;
+            }
+
+            void* memory = boost::alignment::aligned_alloc(alignof(record), sizeof(record));
+
+            if (!memory) throw std::bad_alloc();
+
+            record* r = ::new (memory) record();
+
+            r->next = records_.load(std::memory_order_relaxed);
+
+            while (!records_.compare_exchange_weak(r->next, r, std::memory_order_release, std::memory_order_relaxed));
+
+            return r;
+        }
+
+        // Under the mutex.
+        bool
+        try_advance_()
+        {
+            uint64_t const global = global_.load(std::memory_order_relaxed);
+
+            std::atomic_thread_fence(std::memory_order_seq_cst); // The unlinking before the scan.
+
+            for (record* r = records_.load(std::memory_order_acquire); r; r = r->next)
+            {
+                uint64_t const epoch = r->epoch.load(std::memory_order_acquire);
+
+                if (epoch && epoch != global)
+                    return false;
+            }
+            global_.store(global + 1, std::memory_order_release);
+            return true;
+        }
+
+        std::atomic<uint64_t> global_ { 1 };
+        std::atomic<record*> records_ { nullptr };
+        std::mutex             mutex_;
+        std::vector<retired> retired_;
+    };
+}
+
+template<typename user_type>
+struct impl_ptr_atomic
+{
+    using domain_type = detail::epoch_domain;
+
+    // Reader's view. No copy of the handle. Must not outlive the impl_ptr_atomic.
+    struct snapshot_type
+    {
+       ~snapshot_type () { if (record_) domain_type::instance().leave(record_); }
+        snapshot_type (snapshot_type&& o) noexcept : record_(o.record_), value_(o.value_) { o.record_ = nullptr; }
+        snapshot_type (snapshot_type const&) =delete;
+
+        user_type const* operator->() const { return  value_; }
+        user_type const& operator *() const { return *value_; }
+
+        private:
+
+        friend struct impl_ptr_atomic;
+
+        explicit snapshot_type(std::atomic<user_type*> const& a)
+        :
+            record_(domain_type::local())
+        {
+            domain_type::instance().enter(record_);
+            value_ = a.load(std::memory_order_acquire);
+        }
+
+        domain_type::record* record_;
+        user_type const*      value_;
+    };
+
+   ~impl_ptr_atomic () { delete value_.load(std::memory_order_relaxed); } // No readers left.
+
+    explicit impl_ptr_atomic (user_type const& u) : value_(new user_type(u)) {}
+    impl_ptr_atomic (impl_ptr_atomic const&) =delete;
+
+    snapshot_type snapshot () const { return snapshot_type(value_); }
+    user_type         load () const { return *snapshot(); }
+    void             store (user_type const& u) { exchange(u); }
+
+    user_type
+    exchange(user_type const& u)
+    {
+        user_type* old = value_.exchange(new user_type(u), std::memory_order_acq_rel);
+        user_type  result = *old;
+
+        retire_(old);
+        return result;
+    }
+
+    // Replaces the value when it refers to the same implementation as 'expected'.
+    // Otherwise, 'expected' becomes the current value.
+    bool
+    compare_exchange(user_type& expected, user_type const& desired)
+    {
+        snapshot_type current = snapshot(); // Keeps 'cur' alive while compared.
+        user_type*       fresh = new user_type(desired);
+        user_type*         cur = value_.load(std::memory_order_acquire);
+
+        for (;;)
+        {
+            if (!(*cur == expected))
+            {
+                expected = *cur;
+                delete fresh;
+                return false;
+            }
+            if (value_.compare_exchange_weak(cur, fresh, std::memory_order_acq_rel, std::memory_order_acquire))
+            {
+                retire_(cur);
+                return true;
+            }
+        }
+    }
+
+    private:
+
+    static void retire_ (user_type* p) { domain_type::instance().retire(p, [](void* v){ delete static_cast<user_type*>(v); }); }
+
+    std::atomic<user_type*> value_;
+};
+
+namespace boost
+{
+    template<typename user_type>
+    using impl_ptr_atomic = ::impl_ptr_atomic<user_type>;
+}
+
+#endif // IMPL_PTR_DETAIL_EPOCH_HPP
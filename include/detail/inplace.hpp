@@ -9,13 +9,15 @@
 #include <boost/compressed_pair.hpp>
 #include <boost/config.hpp>
 #include <boost/core/ignore_unused.hpp>
+#include <cstring>
 #include <new>
 #include "./detail.hpp"
 
 namespace detail
 {
-    template<typename, typename, typename> struct basic_inplace;
+    template<typename, typename, typename, typename...> struct basic_inplace;
     struct exists_always;
+    struct exists_in_tail;
 }
 
 namespace impl_ptr_policy
@@ -25,10 +27,19 @@ namespace impl_ptr_policy
         static size_t constexpr size = s;
         static size_t constexpr alignment = a;
     };
-    template<typename impl_type, typename size_type>
-    using        inplace = detail::basic_inplace<impl_type, size_type, /* exists_type = */ bool>;
-    template<typename impl_type, typename size_type>
-    using always_inplace = detail::basic_inplace<impl_type, size_type, /* exists_type = */ detail::exists_always>;
+    // Option. The implementation (checked where it is complete) is trivially copyable and
+    // destructible. Then, copy, move, swap and destruction are plain memory copies (or nothing).
+    // Without the option, the same is detected at run time (one branch instead of a call).
+    struct trivially_copyable {};
+
+    // Option. The null state is kept in the last byte of the storage instead of a separate flag.
+    // Then, sizeof(handle) is the storage size and implementations may use all but one byte of it.
+    struct tail_flag {};
+
+    template<typename impl_type, typename size_type, typename... options>
+    using        inplace = detail::basic_inplace<impl_type, size_type, /* exists_type = */ bool, options...>;
+    template<typename impl_type, typename size_type, typename... options>
+    using always_inplace = detail::basic_inplace<impl_type, size_type, /* exists_type = */ detail::exists_always, options...>;
 }
 
 namespace detail
@@ -56,38 +67,58 @@ struct detail::exists_always
     }
 };
 
+// The state is in the storage itself (policy::tail_flag).
+struct detail::exists_in_tail
+{
+    constexpr explicit exists_in_tail(bool) {}
+};
+
 static_assert(std::is_empty<detail::exists_always>::value, "detail::exists_always causes memory overhead");
 
-template<typename impl_type, typename size_type, typename exists_type>
+template<typename impl_type, typename size_type, typename exists_type, typename... options>
 struct detail::basic_inplace // Proof of concept
 {
     using    this_type = basic_inplace;
     using storage_type = boost::aligned_storage<size_type::size, size_type::alignment>;
     using  traits_type = traits::copyable<impl_type, inplace_allocator<>>;
     using   alloc_type = typename traits_type::alloc_type;
+    using      trivial = has_option<impl_ptr_policy::trivially_copyable, options...>;
+    using         tail = has_option<impl_ptr_policy::tail_flag, options...>;
+    using   state_type = typename std::conditional<tail::value, exists_in_tail, exists_type>::type;
+
+    static_assert(!tail::value || std::is_same<exists_type, bool>::value, "policy::tail_flag is only for policy::inplace");
+
+    // Only trivially copyable implementations are known (at compile time) to move without
+    // throwing and to survive being relocated with memcpy.
+    using trivially_relocatable = trivial;
 
    ~basic_inplace ()
     {
-        if (exists())
-            traits_type::destroy(get());
+        alloc_type a; // The in-place "allocator" is stateless. Then, it is not stored.
+
+        if (exists() && !trivial_())
+            traits_type::destroy(a, get());
     }
     BOOST_CXX14_CONSTEXPR basic_inplace (std::nullptr_t)
     {
         static_assert(exists_type(false) == false, "Constructing null-state is prohibited.");
+        init_tail(tail());
     }
     BOOST_CXX14_CONSTEXPR basic_inplace (this_type const& o)
     {
+        init_tail(tail());
         _assign(o);
     }
-    BOOST_CXX14_CONSTEXPR basic_inplace (this_type&& o)
+    BOOST_CXX14_CONSTEXPR basic_inplace (this_type&& o) noexcept(trivial::value)
     {
+        init_tail(tail());
         _assign(std::move(o));
     }
     BOOST_CXX14_CONSTEXPR this_type& operator=(this_type const& o)
     {
         return _assign(o);
     }
-    BOOST_CXX14_CONSTEXPR this_type& operator=(this_type&& o)
+    BOOST_CXX14_CONSTEXPR this_type& operator=(this_type&& o) noexcept(trivial::value)
     {
         return _assign(std::move(o));
     }
@@ -95,6 +126,7 @@ struct detail::basic_inplace // Proof of concept
     template<typename... arg_types>
     basic_inplace(detail::in_place_type, arg_types&&... args)
     {
+        init_tail(tail());
         _construct<impl_type>(std::forward<arg_types>(args)...);
     }
 
@@ -104,22 +136,57 @@ struct detail::basic_inplace // Proof of concept
         static_assert(exists_type(false) == false, "Emplacing to storage that doesn't support null-state is prohibited.");
         if (exists())
         {
+            alloc_type a;
+            impl_type* p = get();
+
             set_exists(false);
-            traits_type::destroy(get());
+            if (!trivial_()) traits_type::destroy(a, p);
         }
         return _construct<derived_type>(std::forward<arg_types>(args)...);
     }
 
+    void
+    swap(this_type& o) noexcept(trivial::value)
+    {
+        if (trivial::value || ((exists() || o.exists()) && trivial_(o)))
+        {
+            alignas(storage_type) unsigned char tmp[sizeof(storage_type)];
+
+            std::memcpy(tmp, storage().address(), sizeof(storage_type));
+            std::memcpy(storage().address(), o.storage().address(), sizeof(storage_type));
+            std::memcpy(o.storage().address(), tmp, sizeof(storage_type));
+
+            if (!tail::value) // policy::tail_flag: the flags are swapped with the storage.
+            {
+                bool const e = exists(); set_exists(o.exists()); o.set_exists(e);
+            }
+        }
+        else
+        {
+            this_type tmp (std::move(o));
+
+            o     = std::move(*this);
+            *this = std::move(tmp);
+        }
+    }
+
     impl_type* get () const { return exists() ? (impl_type*) storage().address() : nullptr; }
 
     private:
+
+    // Only asked when there is an implementation, i.e. the traits table is published.
+    bool trivial_ () const { return trivial::value || traits_type::trivial(); }
+    bool trivial_ (this_type const& o) const { return exists() ? trivial_() : o.trivial_(); }
+
     template<typename derived_type, typename... arg_types>
     void _construct(arg_types&&... args)
     {
-        static_assert(sizeof(derived_type) <= sizeof(storage_type),
-                "Attempting to construct type larger than storage area");
+        static_assert(sizeof(derived_type) <= sizeof(storage_type) - (tail::value ? 1 : 0),
+                "Attempting to construct type larger than storage area (less the tail byte with policy::tail_flag)");
         static_assert((alignof(storage_type) % alignof(derived_type)) == 0,
                 "Attempting to construct type in storage area that does not have an integer multiple of the type's alignment requirement.");
+        static_assert(!trivial::value || (std::is_trivially_copyable<derived_type>::value && std::is_trivially_destructible<derived_type>::value),
+                "policy::trivially_copyable requires a trivially copyable and destructible implementation");
 
         using alloc_type = typename std::allocator_traits<basic_inplace::alloc_type>::template rebind_alloc<derived_type>;
         alloc_type a;
@@ -136,11 +203,17 @@ struct detail::basic_inplace // Proof of concept
 
         const bool   exists = this->exists();
         const bool o_exists =     o.exists();
+        alloc_type        a;
 
         /**/ if (!exists && !o_exists);
+        else if (trivial_(o))
+        {
+            if (o_exists && this != &o) std::memcpy(storage().address(), o.storage().address(), sizeof(storage_type)); // Null storage is not read.
+            set_exists(o_exists);
+        }
         else if ( exists &&  o_exists) traits_type::assign(get(), std::forward<uref>(*o.get()));
-        else if ( exists && !o_exists) { set_exists(false); traits_type::destroy(get()); }
-        else if (!exists &&  o_exists) { traits_type::construct(storage().address(), std::forward<uref>(*o.get())); set_exists(true); }
+        else if ( exists && !o_exists) { impl_type* p = get(); set_exists(false); traits_type::destroy(a, p); }
+        else if (!exists &&  o_exists) { traits_type::construct(a, storage().address(), std::forward<uref>(*o.get())); set_exists(true); }
 
         return *this;
     }
@@ -155,21 +228,26 @@ struct detail::basic_inplace // Proof of concept
         return storage_and_state_.first();
     }
 
-    constexpr bool exists() const
-    {
-        return storage_and_state_.second();
-    }
+    constexpr bool exists() const { return exists(tail()); }
+    BOOST_CXX14_CONSTEXPR void set_exists(bool exists) { set_exists(exists, tail()); }
 
-    BOOST_CXX14_CONSTEXPR void set_exists(bool exists)
-    {
-        storage_and_state_.second() = exists;
-    }
+    unsigned char&       tail_byte ()       { return static_cast<unsigned char*>(storage().address())[sizeof(storage_type) - 1]; }
+    unsigned char const& tail_byte () const { return static_cast<unsigned char const*>(storage().address())[sizeof(storage_type) - 1]; }
+
+    constexpr bool exists (std::false_type) const { return storage_and_state_.second(); }
+    constexpr bool exists (std::true_type ) const { return tail_byte(); }
+
+    BOOST_CXX14_CONSTEXPR void set_exists(bool exists, std::false_type) { storage_and_state_.second() = exists; }
+    BOOST_CXX14_CONSTEXPR void set_exists(bool exists, std::true_type ) { tail_byte() = exists; }
+
+    void init_tail (std::false_type) {}
+    void init_tail (std::true_type ) { tail_byte() = 0; }
 
     boost::compressed_pair<
         // storage_type must be the first here to ensure it starts at offset 0 in this struct
         storage_type
-      , exists_type
-      > storage_and_state_ { exists_type(false) };
+      , state_type
+      > storage_and_state_ { state_type(false) };
 };
 
 #endif // IMPL_PTR_DETAIL_INPLACE_HPP
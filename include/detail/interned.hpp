@@ -0,0 +1,153 @@
+// Copyright (c) 2008 Vladimir Batov.
+// Use, modification and distribution are subject to the Boost Software License,
+// Version 1.0. See http://www.boost.org/LICENSE_1_0.txt.
+
+#ifndef IMPL_PTR_DETAIL_INTERNED_HPP
+#define IMPL_PTR_DETAIL_INTERNED_HPP
+
+#include "./detail.hpp"
+#include <boost/functional/hash.hpp>
+#include <boost/unordered_map.hpp>
+#include <boost/utility/string_view.hpp>
+#include <mutex>
+#include <new>
+#include <shared_mutex>
+#include <string>
+
+// Interning (flyweight): one shared implementation per key. A concurrent replacement of
+// the mutex + std::map unique-entry collection (see "Extendible Unique-Entry Collection").
+//
+//     struct Book : boost::impl_ptr<Book>::shared { Book (boost::string_view title); ... };
+//
+//     Book::Book(boost::string_view title) : impl_ptr_type(nullptr)
+//     {
+//         *this = boost::impl_ptr_interned<Book>::get(title, title, author); // key, implementation args...
+//     }
+//
+// 1) For the types with pointer semantics (shared, intrusive, etc. policies).
+// 2) The table is split into shards (by the key hash), every shard with its own
+//    reader-writer lock. Then, lookups of existing entries (the common case) only
+//    take a shared lock, and only of one shard.
+// 3) Lookups are by boost::string_view. Then, they do not allocate. A key is only
+//    copied (into a std::string) when a new entry is added.
+// 4) A new implementation is constructed outside the lock. When another thread adds
+//    the same key meanwhile, the constructed one is discarded and the stored one returned.
+// 5) Entries are never removed. Only usable where impl_ptr<user_type>::implementation is visible.
+
+namespace detail
+{
+    struct interned_hash
+    {
+        size_t operator()(boost::string_view k) const { return boost::hash_range(k.begin(), k.end()); }
+    };
+    struct interned_equal
+    {
+        bool operator()(boost::string_view k1, boost::string_view k2) const { return k1 == k2; }
+    };
+
+    template<typename user_type, size_t num_shards>
+    struct interned_table
+    {
+        static_assert(0 < num_shards && (num_shards & (num_shards - 1)) == 0, "The number of shards must be a power of 2");
+
+        using map_type = boost::unordered_map<std::string, user_type, interned_hash, interned_equal>;
+
+        struct alignas(64) shard // One cache line (at least) per shard.
+        {
+            mutable std::shared_timed_mutex mutex;
+            map_type                          map;
+        };
+
+        // Never destroyed: the entries may be looked up from static destructors. Static (not heap)
+        // storage for the shard alignment.
+        static interned_table&
+        instance()
+        {
+            static typename std::aligned_storage<sizeof(interned_table), alignof(interned_table)>::type storage;
+            static interned_table& single = *::new (&storage) interned_table();
+
+            return single;
+        }
+
+        // Null when not found.
+        user_type
+        find(boost::string_view key, size_t hash) const
+        {
+            shard const&                              s = shard_(hash);
+            std::shared_lock<std::shared_timed_mutex> lock (s.mutex);
+            auto                                  found = s.map.find(key, interned_hash(), interned_equal());
+
+            return found != s.map.end() ? found->second : user_type::null();
+        }
+
+        user_type
+        insert(boost::string_view key, size_t hash, user_type&& candidate)
+        {
+            shard&                                   s = shard_(hash);
+            std::lock_guard<std::shared_timed_mutex> lock (s.mutex);
+            auto                                 found = s.map.find(key, interned_hash(), interned_equal());
+
+            if (found != s.map.end())
+                return found->second; // Added meanwhile.
+
+            return s.map.emplace(std::string(key.data(), key.size()), std::move(candidate)).first->second;
+        }
+
+        size_t
+        size() const
+        {
+            size_t num = 0;
+
+            for (shard const& s : shards_)
+            {
+                std::shared_lock<std::shared_timed_mutex> lock (s.mutex);
+                num += s.map.size();
+            }
+            return num;
+        }
+
+        private:
+
+        // The low bits select the bucket within the shard. The shard is selected by the high ones.
+        shard&       shard_ (size_t hash)       { return shards_[(hash >> (sizeof(size_t) * 8 / 2)) & (num_shards - 1)]; }
+        shard const& shard_ (size_t hash) const { return shards_[(hash >> (sizeof(size_t) * 8 / 2)) & (num_shards - 1)]; }
+
+        shard shards_[num_shards];
+    };
+}
+
+template<typename user_type, size_t num_shards =64>
+struct impl_ptr_interned
+{
+    using table_type = detail::interned_table<user_type, num_shards>;
+
+    // The implementation for the key. Constructed from 'args' when not there yet.
+    template<typename... arg_types>
+    static user_type
+    get(boost::string_view key, arg_types&&... args)
+    {
+        size_t const   hash = detail::interned_hash()(key);
+        user_type     found = table_type::instance().find(key, hash);
+
+        if (found)
+            return found;
+
+        user_type candidate = user_type::null();
+
+        candidate.emplace(std::forward<arg_types>(args)...);
+
+        return table_type::instance().insert(key, hash, std::move(candidate));
+    }
+
+    // The implementation for the key. Null when not there.
+    static user_type find (boost::string_view key) { return table_type::instance().find(key, detail::interned_hash()(key)); }
+    static size_t    size () { return table_type::instance().size(); }
+};
+
+namespace boost
+{
+    template<typename user_type, size_t num_shards =64>
+    using impl_ptr_interned = ::impl_ptr_interned<user_type, num_shards>;
+}
+
+#endif // IMPL_PTR_DETAIL_INTERNED_HPP
@@ -0,0 +1,26 @@
+// Copyright (c) 2008 Vladimir Batov.
+// Use, modification and distribution are subject to the Boost Software License,
+// Version 1.0. See http://www.boost.org/LICENSE_1_0.txt.
+
+#ifndef IMPL_PTR_DETAIL_INTRUSIVE_HPP
+#define IMPL_PTR_DETAIL_INTRUSIVE_HPP
+
+#include "./counted.hpp"
+
+// Shared semantics with a one-pointer handle.
+//
+//     struct Book : boost::impl_ptr<Book, policy::intrusive> { ... };
+//
+// 1) As policy::shared but the atomic count (no weak count, no deleter) is co-allocated
+//    with the implementation. Then, the handle is half of std::shared_ptr.
+// 2) Derived implementations (emplace<derived>) are destroyed as such without a virtual
+//    destructor.
+// 3) The optional (stateless) allocator is the 2nd policy argument.
+
+namespace impl_ptr_policy
+{
+    template<typename impl_type, typename allocator =std::allocator<void>>
+    using intrusive = detail::counted_shared<impl_type, detail::atomic_counter, allocator>;
+}
+
+#endif // IMPL_PTR_DETAIL_INTRUSIVE_HPP
@@ -0,0 +1,192 @@
+// Copyright (c) 2008 Vladimir Batov.
+// Use, modification and distribution are subject to the Boost Software License,
+// Version 1.0. See http://www.boost.org/LICENSE_1_0.txt.
+
+#ifndef IMPL_PTR_DETAIL_LAZY_HPP
+#define IMPL_PTR_DETAIL_LAZY_HPP
+
+#include "./unique.hpp"
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <tuple>
+
+// Thread-safe lazy instantiation. The implementation is constructed on first access.
+//
+//     struct Book : boost::impl_ptr<Book, policy::lazy> { ... };
+//
+//     Book::Book(string const& title) : impl_ptr_type(in_place, title) {} // Nothing constructed yet.
+//     string const& Book::title() const { return (*this)->title; }       // Constructed on first call.
+//
+// 1) 'unique' (move-only) semantics.
+// 2) The constructor arguments are captured (copied) by the in_place constructor. The
+//    implementation is constructed from them on the first get() (i.e. operator->, operator*).
+//    emplace() constructs the implementation right away (as other policies).
+// 3) After the construction, get() is one acquire load. The first access claims the handle
+//    (a 'constructing' sentinel in place of the pointer) and constructs without holding any
+//    lock. Concurrent first accesses wait for it. Then, the implementation is constructed
+//    once, and constructors may access other lazy handles (dependent lazy singletons) but
+//    not their own.
+// 4) The null check (operator bool) does not construct the implementation.
+// 5) The captured arguments live as long as the handle. The allocator is default-constructed
+//    (stateless allocators only).
+
+namespace impl_ptr_policy
+{
+    template<typename, typename =std::allocator<void>> struct lazy;
+}
+
+namespace detail
+{
+    // Slow-path (first access) waiting shared by all lazy handles. Only held to publish the
+    // pointer and to wait for it, never during a construction.
+    struct lazy_waiters
+    {
+        static lazy_waiters& instance () { static lazy_waiters waiters; return waiters; }
+
+        std::mutex                 mutex;
+        std::condition_variable constructed;
+    };
+}
+
+template<typename impl_type, typename allocator>
+struct impl_ptr_policy::lazy
+{
+    using    this_type = lazy;
+    using  traits_type = detail::traits::unique<impl_type, allocator>;
+    using   alloc_type = typename traits_type::alloc_type;
+
+    // No self-references.
+    using trivially_relocatable = detail::relocatable_allocator<alloc_type>;
+
+   ~lazy () { reset(); }
+
+    lazy (std::nullptr_t) {}
+    lazy (this_type&& o) noexcept : impl_(o.impl_.load(std::memory_order_relaxed)), factory_(o.factory_)
+    {
+        o.impl_.store(nullptr, std::memory_order_relaxed);
+        o.factory_ = nullptr;
+    }
+    this_type& operator=(this_type&& o) noexcept { this_type(std::move(o)).swap(*this); return *this; }
+
+    template<typename... arg_types>
+    lazy (detail::in_place_type, arg_types&&... args)
+    :
+        factory_(new factory<typename std::decay<arg_types>::type...>(std::forward<arg_types>(args)...))
+    {}
+
+    template<typename derived_type, typename... arg_types>
+    void
+    emplace(arg_types&&... args)
+    {
+        impl_type* p = traits_type::template make<derived_type>(alloc_type(), detail::in_place_type(), std::forward<arg_types>(args)...).release();
+
+        reset();
+        impl_.store(p, std::memory_order_relaxed);
+    }
+
+    bool operator< (this_type const& o) const { return get() < o.get(); }
+    void      swap (this_type& o) noexcept
+    {
+        impl_type* p = impl_.load(std::memory_order_relaxed);
+
+        impl_.store(o.impl_.load(std::memory_order_relaxed), std::memory_order_relaxed);
+        o.impl_.store(p, std::memory_order_relaxed);
+        std::swap(factory_, o.factory_);
+    }
+
+    impl_type*
+    get() const
+    {
+        impl_type* p = impl_.load(std::memory_order_acquire);
+
+        return BOOST_LIKELY(reinterpret_cast<std::uintptr_t>(p) > 1) ? p : materialize_(); // Neither null nor constructing_().
+    }
+
+    bool   is_null () const { return !factory_ && !impl_.load(std::memory_order_relaxed); }
+    long use_count () const { return 1; }
+
+    private:
+
+    struct factory_base
+    {
+        impl_type* (*make)    (factory_base const*);
+        void       (*destroy) (factory_base*);
+    };
+    template<typename... arg_types>
+    struct factory : factory_base
+    {
+        template<typename... init_types>
+        explicit factory(init_types&&... args) : factory_base{ &make_, &destroy_ }, args_(std::forward<init_types>(args)...) {}
+
+        private:
+
+        template<size_t... indices>
+        impl_type*
+        apply_(std::index_sequence<indices...>) const
+        {
+            return traits_type::template make<impl_type>(alloc_type(), detail::in_place_type(), std::get<indices>(args_)...).release();
+        }
+
+        static impl_type* make_ (factory_base const* f) { return static_cast<factory const*>(f)->apply_(std::index_sequence_for<arg_types...>()); }
+        static void    destroy_ (factory_base* f) { delete static_cast<factory*>(f); }
+
+        std::tuple<arg_types...> args_;
+    };
+
+    static impl_type* constructing_ () { return reinterpret_cast<impl_type*>(1); }
+
+    impl_type*
+    materialize_() const
+    {
+        if (!factory_) return nullptr; // Null handle. 'factory_' only changes with exclusive access.
+
+        impl_type* p = nullptr;
+
+        if (impl_.compare_exchange_strong(p, constructing_(), std::memory_order_acquire))
+        {
+            try { p = factory_->make(factory_); }
+            catch (...) { publish_(nullptr); throw; } // Another access retries.
+
+            publish_(p);
+            return p;
+        }
+        if (p != constructing_()) return p;
+
+        detail::lazy_waiters&           w = detail::lazy_waiters::instance();
+        std::unique_lock<std::mutex> lock (w.mutex);
+
+        w.constructed.wait(lock, [&]{ return (p = impl_.load(std::memory_order_acquire)) != constructing_(); });
+        lock.unlock();
+
+        return p ? p : materialize_();
+    }
+
+    // Stored under the mutex: a waiter cannot miss the notification.
+    void
+    publish_(impl_type* p) const
+    {
+        detail::lazy_waiters& w = detail::lazy_waiters::instance();
+
+        { std::lock_guard<std::mutex> lock (w.mutex); impl_.store(p, std::memory_order_release); }
+
+        w.constructed.notify_all();
+    }
+
+    void
+    reset()
+    {
+        impl_type* p = impl_.load(std::memory_order_relaxed);
+
+        if (p) { alloc_type a; traits_type::destroy(a, p); }
+        if (factory_) factory_->destroy(factory_);
+
+        impl_.store(nullptr, std::memory_order_relaxed);
+        factory_ = nullptr;
+    }
+
+    mutable std::atomic<impl_type*> impl_ { nullptr };
+    factory_base*                factory_ = nullptr;
+};
+
+#endif // IMPL_PTR_DETAIL_LAZY_HPP
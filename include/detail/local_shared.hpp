@@ -0,0 +1,27 @@
+// Copyright (c) 2008 Vladimir Batov.
+// Use, modification and distribution are subject to the Boost Software License,
+// Version 1.0. See http://www.boost.org/LICENSE_1_0.txt.
+
+#ifndef IMPL_PTR_DETAIL_LOCAL_SHARED_HPP
+#define IMPL_PTR_DETAIL_LOCAL_SHARED_HPP
+
+#include "./counted.hpp"
+
+// Shared (pointer) semantics for single-threaded subsystems (event loops, etc.).
+//
+//     struct Session : boost::impl_ptr<Session, policy::local_shared> { ... };
+//
+// 1) As policy::shared but the reference count is a plain (non-atomic) integer.
+//    Then, copying and destroying a handle is an increment/decrement.
+// 2) One allocation for the count and the implementation. The handle is one pointer.
+// 3) All copies of one implementation must be copied and destroyed on one thread.
+//    In debug builds, the use from another thread is asserted.
+// 4) The optional (stateless) allocator is the 2nd policy argument.
+
+namespace impl_ptr_policy
+{
+    template<typename impl_type, typename allocator =std::allocator<void>>
+    using local_shared = detail::counted_shared<impl_type, detail::local_counter, allocator>;
+}
+
+#endif // IMPL_PTR_DETAIL_LOCAL_SHARED_HPP
@@ -0,0 +1,53 @@
+// Copyright (c) 2008 Vladimir Batov.
+// Use, modification and distribution are subject to the Boost Software License,
+// Version 1.0. See http://www.boost.org/LICENSE_1_0.txt.
+
+#ifndef IMPL_PTR_DETAIL_PMR_HPP
+#define IMPL_PTR_DETAIL_PMR_HPP
+
+#include "./shared.hpp"
+#include "./unique.hpp"
+#include "./copied.hpp"
+
+// Opt-in (not included by impl_ptr.hpp). std::pmr when available (C++17). Otherwise,
+// boost::container::pmr (requires linking with the Boost.Container library, i.e. the
+// impl_ptr_pmr CMake target). Define IMPL_PTR_USE_BOOST_PMR to use boost::container::pmr regardless.
+
+#if !defined(IMPL_PTR_USE_BOOST_PMR)
+#   if 201703L <= __cplusplus && defined(__has_include)
+#       if !__has_include(<memory_resource>)
+#           define IMPL_PTR_USE_BOOST_PMR
+#       endif
+#   else
+#       define IMPL_PTR_USE_BOOST_PMR
+#   endif
+#endif
+
+#if defined(IMPL_PTR_USE_BOOST_PMR)
+#   include <boost/container/pmr/global_resource.hpp>
+#   include <boost/container/pmr/memory_resource.hpp>
+#   include <boost/container/pmr/monotonic_buffer_resource.hpp>
+#   include <boost/container/pmr/polymorphic_allocator.hpp>
+#   include <boost/container/pmr/synchronized_pool_resource.hpp>
+#   include <boost/container/pmr/unsynchronized_pool_resource.hpp>
+    namespace impl_ptr_policy { namespace pmr = boost::container::pmr; }
+#else
+#   include <memory_resource>
+    namespace impl_ptr_policy { namespace pmr = std::pmr; }
+#endif
+
+// Policies allocating implementations from a memory_resource, e.g.
+//     struct Book : boost::impl_ptr<Book, policy::pmr_copied> { ... };
+//     Book::Book(policy::pmr::memory_resource* mr, ...) : impl_ptr_type(std::allocator_arg, mr, in_place, ...) {}
+// The resource is given at construction (the default resource when not given).
+// As with std::pmr containers, the resource does not propagate on assignment or swap
+// and a copy is allocated from the default resource.
+
+namespace impl_ptr_policy
+{
+    template<typename impl_type> using pmr_unique = unique<impl_type, pmr::polymorphic_allocator<impl_type>>;
+    template<typename impl_type> using pmr_copied = copied<impl_type, pmr::polymorphic_allocator<impl_type>>;
+    template<typename impl_type> using pmr_shared = shared<impl_type, pmr::polymorphic_allocator<impl_type>>;
+}
+
+#endif // IMPL_PTR_DETAIL_PMR_HPP
@@ -0,0 +1,252 @@
+// Copyright (c) 2008 Vladimir Batov.
+// Use, modification and distribution are subject to the Boost Software License,
+// Version 1.0. See http://www.boost.org/LICENSE_1_0.txt.
+
+#ifndef IMPL_PTR_DETAIL_POOL_HPP
+#define IMPL_PTR_DETAIL_POOL_HPP
+
+#include "./unique.hpp"
+#include "./copied.hpp"
+#include <boost/align/aligned_alloc.hpp>
+#include <boost/core/ignore_unused.hpp>
+#include <boost/lockfree/stack.hpp>
+#include <cstdint>
+#include <cstring>
+#include <mutex>
+#include <new>
+#include <vector>
+
+// Pooled allocation for implementations created and destroyed at high rates.
+//
+//     struct Item : boost::impl_ptr<Item, policy::pool> { ... };
+//     ...
+//     boost::impl_ptr_pool<Item>::reserve(100000); // Optional warm-up (in the implementation file).
+//
+// 1) policy::pool has 'unique' semantics, policy::copied_pool has 'copied' semantics.
+// 2) Every implementation type has its own pool of fixed-size slots carved from 64KB slabs.
+// 3) Every thread caches a magazine (a batch) of free slots. Allocation and deallocation
+//    only touch that thread-local magazine. Full and empty magazines are exchanged
+//    through lock-free global stacks. A mutex is only taken to carve a new slab.
+// 4) A slot can be deallocated by any thread and through any pool allocator (e.g. the
+//    one of the base implementation after emplace<derived>()). The slab header knows its pool.
+// 5) Slabs are never returned to the system.
+
+namespace detail
+{
+    struct slab_pool_base
+    {
+        static size_t constexpr     slab_size = 64 * 1024; // Slabs are aligned to their size.
+        static size_t constexpr magazine_size = 64;
+
+        struct magazine { size_t count; void* slots[magazine_size]; };
+        struct     slab { slab_pool_base* owner; };
+
+        static void
+        deallocate(void* p)
+        {
+            slab_pool_base* owner = reinterpret_cast<slab*>(std::uintptr_t(p) & ~std::uintptr_t(slab_size - 1))->owner;
+
+            owner->deallocate_(p);
+        }
+
+        protected:
+
+        explicit slab_pool_base(void (*d)(void*)) : deallocate_(d) {}
+
+        void (*const deallocate_)(void*);
+    };
+
+    template<typename impl_type>
+    struct slab_pool : slab_pool_base
+    {
+        static size_t constexpr      alignment = alignof(impl_type) < alignof(void*) ? alignof(void*) : alignof(impl_type);
+        static size_t constexpr      slot_size = (sizeof(impl_type) + alignment - 1) / alignment * alignment;
+        static size_t constexpr     first_slot = (sizeof(slab) + alignment - 1) / alignment * alignment;
+        static size_t constexpr slots_per_slab = (slab_size - first_slot) / slot_size;
+        static size_t constexpr  magazine_fill = slots_per_slab < magazine_size ? slots_per_slab : magazine_size;
+
+        static_assert(0 < slots_per_slab, "Implementation is too large for the pool policy");
+        static_assert(alignment <= slab_size / 2, "Implementation alignment is too strict for the pool policy");
+
+        static slab_pool& instance()
+        {
+            static slab_pool& single = *new slab_pool(); // Never destroyed. Outlives all thread caches.
+            return single;
+        }
+
+        static void*
+        allocate()
+        {
+            magazine*& m = cache().loaded;
+
+            if (BOOST_UNLIKELY(!m || !m->count))
+                m = instance().exchange_empty(m);
+
+            return m->slots[--m->count];
+        }
+
+        static void
+        deallocate_local(void* p)
+        {
+            magazine*& m = cache().loaded;
+
+            if (BOOST_UNLIKELY(!m || m->count == magazine_fill))
+                m = instance().exchange_full(m);
+
+            m->slots[m->count++] = p;
+        }
+
+        // Make sure at least 'num' slots have been carved. Optionally, touch the memory upfront.
+        void
+        reserve(size_t num, bool prefault)
+        {
+            std::lock_guard<std::mutex> lock (mutex_);
+
+            while (capacity_ < num)
+                for (magazine* m : carve(prefault))
+                    full_.push(m);
+        }
+
+        size_t capacity () const { std::lock_guard<std::mutex> lock (mutex_); return capacity_; }
+
+        private:
+
+        struct thread_cache
+        {
+           ~thread_cache() { if (loaded) instance().release(loaded); }
+
+            magazine* loaded = nullptr;
+        };
+
+        slab_pool() : slab_pool_base(&slab_pool::deallocate_local), full_(64), empty_(64) {}
+
+        static thread_cache& cache() { static thread_local thread_cache local; return local; }
+
+        magazine*
+        new_magazine()
+        {
+            magazine* m = nullptr;
+
+            if (!empty_.pop(m))
+                m = new magazine;
+
+            m->count = 0;
+            return m;
+        }
+
+        // The thread's magazine is empty: swap it for a full one.
+        magazine*
+        exchange_empty(magazine* m)
+        {
+            magazine* full = nullptr;
+
+            if (m) empty_.push(m);
+            if (full_.pop(full)) return full;
+
+            std::lock_guard<std::mutex> lock (mutex_);
+            std::vector<magazine*> carved = carve(false);
+
+            for (size_t k = 1; k < carved.size(); ++k)
+                full_.push(carved[k]);
+
+            return carved[0];
+        }
+
+        // The thread's magazine is full: swap it for an empty one.
+        magazine*
+        exchange_full(magazine* m)
+        {
+            if (m) full_.push(m);
+
+            return new_magazine();
+        }
+
+        void
+        release(magazine* m)
+        {
+            if (m->count) full_.push(m);
+            else empty_.push(m);
+        }
+
+        // Carve a new slab into magazines of free slots. Called under the mutex.
+        std::vector<magazine*>
+        carve(bool prefault)
+        {
+            void* memory = boost::alignment::aligned_alloc(slab_size, slab_size);
+
+            if (!memory) throw std::bad_alloc();
+            if (prefault) std::memset(memory, 0, slab_size);
+
+            slab*                  s = new (memory) slab { this };
+            char*               slot = reinterpret_cast<char*>(s) + first_slot;
+            std::vector<magazine*> magazines;
+
+            for (size_t k = 0; k < slots_per_slab; ++k, slot += slot_size)
+            {
+                if (k % magazine_fill == 0)
+                    magazines.push_back(new_magazine());
+
+                magazines.back()->slots[magazines.back()->count++] = slot;
+            }
+            capacity_ += slots_per_slab;
+
+            return magazines;
+        }
+
+        boost::lockfree::stack<magazine*> full_;
+        boost::lockfree::stack<magazine*> empty_;
+        mutable std::mutex                mutex_;
+        size_t                            capacity_ = 0;
+    };
+}
+
+namespace impl_ptr_policy
+{
+    template<typename impl_type>
+    struct pool_allocator
+    {
+        using value_type = impl_type;
+
+        pool_allocator () noexcept =default;
+
+        template<typename other_type>
+        pool_allocator (pool_allocator<other_type> const&) noexcept {}
+
+        impl_type*
+        allocate(size_t num)
+        {
+            BOOST_ASSERT(num == 1); // Implementations are allocated one at a time.
+            boost::ignore_unused(num);
+
+            return static_cast<impl_type*>(detail::slab_pool<impl_type>::allocate());
+        }
+        void deallocate(impl_type* p, size_t) noexcept { detail::slab_pool_base::deallocate(p); }
+
+        template<typename other_type> bool operator==(pool_allocator<other_type> const&) const { return true; }
+        template<typename other_type> bool operator!=(pool_allocator<other_type> const&) const { return false; }
+    };
+
+    template<typename impl_type, typename...>
+    using pool = unique<impl_type, pool_allocator<impl_type>>;
+
+    template<typename impl_type, typename...>
+    using copied_pool = copied<impl_type, pool_allocator<impl_type>>;
+}
+
+// Pool warm-up. Only usable where impl_ptr<user_type>::implementation is visible.
+template<typename user_type>
+struct impl_ptr_pool
+{
+    using pool_type = detail::slab_pool<typename user_type::impl_type>;
+
+    static void   reserve (size_t num, bool prefault =true) { pool_type::instance().reserve(num, prefault); }
+    static size_t capacity () { return pool_type::instance().capacity(); }
+};
+
+namespace boost
+{
+    template<typename user_type>
+    using impl_ptr_pool = ::impl_ptr_pool<user_type>;
+}
+
+#endif // IMPL_PTR_DETAIL_POOL_HPP
@@ -0,0 +1,182 @@
+// Copyright (c) 2008 Vladimir Batov.
+// Use, modification and distribution are subject to the Boost Software License,
+// Version 1.0. See http://www.boost.org/LICENSE_1_0.txt.
+
+#ifndef IMPL_PTR_DETAIL_REGION_HPP
+#define IMPL_PTR_DETAIL_REGION_HPP
+
+#include "./unique.hpp"
+#include "./copied.hpp"
+#include <boost/core/noncopyable.hpp>
+#include <algorithm>
+#include <stdexcept>
+#include <cstdint>
+#include <cstdlib>
+
+// Region (arena) allocation for Pimpls living as long as one request, one batch job, etc.
+//
+//     struct Item : boost::impl_ptr<Item, policy::region> { ... };
+//     ...
+//     {
+//         impl_ptr_region region; // Becomes the region of this thread.
+//
+//         Item i1, i2, ...;       // Implementations are bump-allocated from 'region'.
+//         ...
+//     }                           // The memory of all implementations is released in one go.
+//
+// 1) policy::region has 'unique' semantics, policy::copied_region has 'copied' semantics.
+//    A copy is allocated from the region active at the time of copying.
+// 2) With no active region, implementations are allocated from the heap.
+// 3) With policy::skip_destructors, implementations must be trivially destructible and
+//    then destroying a Pimpl does nothing at all. Otherwise, Pimpls must be destroyed
+//    before their region.
+// 4) A region is not thread-safe. It is meant to be used by the thread that created it.
+
+struct impl_ptr_region : boost::noncopyable
+{
+    explicit impl_ptr_region(size_t chunk_size =64 * 1024)
+    :
+        chunk_size_(chunk_size), previous_(current_())
+    {
+        current_() = this;
+    }
+   ~impl_ptr_region()
+    {
+        BOOST_ASSERT(current_() == this); // Regions are scoped, i.e. released in the reverse order.
+        BOOST_ASSERT(live_ == 0);         // Implementations with destructors must not outlive their region.
+
+        current_() = previous_;
+
+        for (chunk* c = chunks_, *next; c; c = next)
+        {
+            next = c->next;
+            std::free(c);
+        }
+    }
+
+    static impl_ptr_region* current () { return current_(); }
+
+    // Allocations to be destroyed are expected to be deallocated before the region is released.
+    void*
+    allocate(size_t size, size_t alignment, bool destroyed =true)
+    {
+        char* p = align(cur_, alignment);
+
+        if (!p || end_ < p || size_t(end_ - p) < size)
+            p = align(grow(size + alignment), alignment);
+
+        cur_   = p + size;
+        live_ += destroyed ? 1 : 0;
+
+        return p;
+    }
+    void deallocate(void*, size_t) noexcept { live_ -= 1; } // The memory is released in bulk.
+
+    private:
+
+    struct chunk { chunk* next; };
+
+    static impl_ptr_region*& current_()
+    {
+        static thread_local impl_ptr_region* region;
+        return region;
+    }
+
+    static char*
+    align(char* p, size_t alignment)
+    {
+        std::uintptr_t const addr = reinterpret_cast<std::uintptr_t>(p);
+        return p ? p + ((alignment - addr % alignment) % alignment) : p;
+    }
+
+    char*
+    grow(size_t min_size)
+    {
+        size_t const size = (std::max)(chunk_size_, min_size) + sizeof(chunk);
+        chunk* const    c = static_cast<chunk*>(std::malloc(size));
+
+        if (!c) throw std::bad_alloc();
+
+        c->next = chunks_;
+        chunks_ = c;
+        cur_    = reinterpret_cast<char*>(c + 1);
+        end_    = reinterpret_cast<char*>(c) + size;
+
+        return cur_;
+    }
+
+    size_t const     chunk_size_;
+    impl_ptr_region*   previous_;
+    chunk*               chunks_ = nullptr;
+    char*                   cur_ = nullptr;
+    char*                   end_ = nullptr;
+    size_t                 live_ = 0;
+};
+
+namespace impl_ptr_policy
+{
+    struct skip_destructors {};
+
+    template<typename impl_type, bool skip>
+    struct region_allocator
+    {
+        using                             value_type = impl_type;
+        using                      skips_destruction = std::integral_constant<bool, skip>;
+        using propagate_on_container_move_assignment = std::true_type; // Implementations stay in their regions.
+        using            propagate_on_container_swap = std::true_type;
+
+        template<typename other_type> struct rebind { using other = region_allocator<other_type, skip>; };
+
+        region_allocator () noexcept : region_(impl_ptr_region::current()) {}
+        explicit region_allocator (impl_ptr_region& r) noexcept : region_(&r) {}
+
+        template<typename other_type>
+        region_allocator (region_allocator<other_type, skip> const& o) noexcept : region_(o.region()) {}
+
+        impl_type*
+        allocate(size_t num)
+        {
+            if (region_)
+                return static_cast<impl_type*>(region_->allocate(num * sizeof(impl_type), alignof(impl_type), !skip));
+
+            if (skip) // Heap memory would leak.
+                throw std::logic_error("impl_ptr_region: no active region to allocate from");
+
+            return std::allocator<impl_type>().allocate(num);
+        }
+        void
+        deallocate(impl_type* p, size_t num)
+        {
+            if (region_) region_->deallocate(p, num * sizeof(impl_type));
+            else std::allocator<impl_type>().deallocate(p, num);
+        }
+
+        // A copy is allocated from the currently active region.
+        region_allocator select_on_container_copy_construction () const { return region_allocator(); }
+
+        impl_ptr_region* region () const { return region_; }
+
+        template<typename other_type>
+        bool operator==(region_allocator<other_type, skip> const& o) const { return region_ == o.region(); }
+        template<typename other_type>
+        bool operator!=(region_allocator<other_type, skip> const& o) const { return region_ != o.region(); }
+
+        private: impl_ptr_region* region_;
+    };
+
+    template<typename impl_type, typename... options>
+    using region_allocator_for = region_allocator<impl_type, detail::has_option<skip_destructors, options...>::value>;
+
+    template<typename impl_type, typename... options>
+    using region = unique<impl_type, region_allocator_for<impl_type, options...>>;
+
+    template<typename impl_type, typename... options>
+    using copied_region = copied<impl_type, region_allocator_for<impl_type, options...>>;
+}
+
+namespace boost
+{
+    using impl_ptr_region = ::impl_ptr_region;
+}
+
+#endif // IMPL_PTR_DETAIL_REGION_HPP
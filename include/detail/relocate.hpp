@@ -0,0 +1,115 @@
+// Copyright (c) 2008 Vladimir Batov.
+// Use, modification and distribution are subject to the Boost Software License,
+// Version 1.0. See http://www.boost.org/LICENSE_1_0.txt.
+
+#ifndef IMPL_PTR_DETAIL_RELOCATE_HPP
+#define IMPL_PTR_DETAIL_RELOCATE_HPP
+
+#include "./detail.hpp"
+#include <cstring>
+#include <new>
+
+// Relocation: moving an object to new memory and ending the life of the original.
+// For most Pimpls that is a memcpy of the handle: it is just a pointer (and a stateless
+// allocator) and nothing points back into it.
+//
+//     boost::uninitialized_relocate(old_buffer, old_buffer + size, new_buffer);
+//
+// 1) boost::is_trivially_relocatable<T> is true for trivially copyable types and for
+//    Pimpls opted in by the user class whose policy declares 'trivially_relocatable'
+//    (unique, copied, shared and the policies based on them with stateless allocators;
+//    inplace with trivially_copyable). It can be specialized (opted in) for other types.
+// 2) A Pimpl class opts in with 'using trivially_relocatable = std::true_type;'. The class
+//    has no special member functions of its own (e.g. registering 'this') and no data
+//    members (checked). Relocation is not inferred from the size alone. Classes derived
+//    from an opted-in Pimpl inherit the opt-in (to be re-declared std::false_type if not).
+// 3) Otherwise, relocation is a move-construction followed by the destruction of the source.
+
+namespace detail
+{
+    template<typename, typename =void>
+    struct relocatable_policy : std::false_type {};
+
+    template<typename PT>
+    struct relocatable_policy<PT, typename std::conditional<true, void, typename PT::trivially_relocatable>::type>
+    :
+        PT::trivially_relocatable
+    {};
+
+    // The user class opted in (see 2).
+    template<typename, typename =void>
+    struct relocatable_user : std::false_type {};
+
+    template<typename T>
+    struct relocatable_user<T, typename std::conditional<true, void, typename T::trivially_relocatable>::type>
+    :
+        T::trivially_relocatable
+    {};
+
+    template<typename T>
+    T*
+    relocate_at(T* from, T* to, std::true_type)
+    {
+        std::memcpy(static_cast<void*>(to), static_cast<void const*>(from), sizeof(T));
+        return to;
+    }
+    template<typename T>
+    T*
+    relocate_at(T* from, T* to, std::false_type)
+    {
+        T* p = ::new (static_cast<void*>(to)) T(std::move(*from));
+        from->~T();
+        return p;
+    }
+    template<typename T>
+    T*
+    uninitialized_relocate(T* first, T* last, T* out, std::true_type)
+    {
+        if (first != last)
+            std::memmove(static_cast<void*>(out), static_cast<void const*>(first), (last - first) * sizeof(T));
+
+        return out + (last - first);
+    }
+    template<typename T>
+    T*
+    uninitialized_relocate(T* first, T* last, T* out, std::false_type)
+    {
+        for (; first != last; ++first, ++out)
+            relocate_at(first, out, std::false_type());
+
+        return out;
+    }
+}
+
+namespace boost
+{
+    template<typename T, typename =void>
+    struct is_trivially_relocatable : std::integral_constant<bool, std::is_trivially_copyable<T>::value> {};
+
+    template<typename T>
+    struct is_trivially_relocatable<T, typename std::conditional<true, void, typename T::impl_ptr_type>::type>
+    :
+        std::integral_constant<bool,
+            sizeof(T) == sizeof(typename T::impl_ptr_type) &&
+            ::detail::relocatable_user<T>::value &&
+            ::detail::relocatable_policy<typename T::impl_ptr_type::policy_type>::value>
+    {};
+
+    // Relocates *from into the uninitialized 'to'. *from is not to be destroyed afterwards.
+    template<typename T>
+    T*
+    relocate_at(T* from, T* to) noexcept(is_trivially_relocatable<T>::value || std::is_nothrow_move_constructible<T>::value)
+    {
+        return ::detail::relocate_at(from, to, is_trivially_relocatable<T>());
+    }
+
+    // Relocates [first, last) into the uninitialized memory at 'out'. Returns the end of the relocated range.
+    template<typename T>
+    T*
+    uninitialized_relocate(T* first, T* last, T* out) noexcept(is_trivially_relocatable<T>::value || std::is_nothrow_move_constructible<T>::value)
+    {
+        return ::detail::uninitialized_relocate(first, last, out, is_trivially_relocatable<T>());
+    }
+}
+
+#endif // IMPL_PTR_DETAIL_RELOCATE_HPP
@@ -0,0 +1,306 @@
+// Copyright (c) 2008 Vladimir Batov.
+// Use, modification and distribution are subject to the Boost Software License,
+// Version 1.0. See http://www.boost.org/LICENSE_1_0.txt.
+
+#ifndef IMPL_PTR_DETAIL_REPLICATED_HPP
+#define IMPL_PTR_DETAIL_REPLICATED_HPP
+
+#include "./detail.hpp"
+#include <boost/align/aligned_alloc.hpp>
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <new>
+#include <thread>
+#include <vector>
+
+// Replicated shared implementations for globally shared read-mostly objects (singletons,
+// configurations, etc.) accessed from many cores.
+//
+//     struct Single : boost::impl_ptr<Single, policy::replicated> { ... };
+//
+//     int  Single::value () const { return (*this)->value; }                           // Local replica.
+//     void Single::value (int v) { update([v](impl_type& impl){ impl.value = v; }); } // All replicas.
+//
+// 1) Shared semantics as policy::shared. The implementation is copied into a few replicas
+//    (the hardware concurrency rounded up to a power of 2, up to 64), each in its own cache
+//    lines. Every thread reads the replica of its slot (threads are assigned slots round-robin).
+// 2) Const access only ('impl_type const*'). Modifications are made by update(): applied to
+//    a copy of the implementation, copied into new replicas and published (an atomic pointer
+//    store per slot). Then, update() may run concurrently with readers and other updates
+//    (serialized). A reader sees either the old or the new replica of its slot.
+// 3) Readers hold plain pointers (no epoch to leave). Then, the superseded replicas of the
+//    last 'retained' updates are kept and older ones released: a pointer from get() (e.g.
+//    operator->) must not be used across more than 'retained' - 1 later updates. The memory
+//    is bounded (by 'retained' + 1 generations). For frequently replaced implementations see
+//    impl_ptr_atomic (reclaimed as readers leave).
+// 4) Handles are counted per slot (on the replica cache line). Only the first handle of a slot
+//    updates the object-wide count. Then, copies made on one core do not bounce a counter
+//    between cores. The handle is two words (the object and the slot it is counted in).
+// 5) The implementation (of its most-derived type) must be copy-constructible.
+
+namespace impl_ptr_policy
+{
+    template<typename> struct replicated;
+}
+
+namespace detail
+{
+    // This thread's replica slot (any number; masked by the object).
+    inline unsigned
+    replica_slot()
+    {
+        static std::atomic<unsigned>  next { 0 };
+        static thread_local unsigned slot = 0; // Constant-initialized: no guard.
+
+        if (BOOST_UNLIKELY(!slot))
+            slot = ++next;
+
+        return slot;
+    }
+
+    inline unsigned
+    replica_count()
+    {
+        static unsigned const count = []
+        {
+            unsigned const hardware = std::max(1u, std::min(64u, std::thread::hardware_concurrency()));
+            unsigned          count = 1;
+
+            while (count < hardware) count *= 2;
+
+            return count;
+        }();
+        return count;
+    }
+
+    inline void*
+    replica_alloc(size_t size)
+    {
+        void* p = boost::alignment::aligned_alloc(64, (size + 63) / 64 * 64);
+
+        if (!p) throw std::bad_alloc();
+
+        return p;
+    }
+}
+
+template<typename impl_type>
+struct impl_ptr_policy::replicated
+{
+    using this_type = replicated;
+
+    static constexpr unsigned retained = 4; // Superseded generations kept for readers.
+
+    // No self-references.
+    using trivially_relocatable = std::true_type;
+
+   ~replicated () { release_(); }
+
+    replicated (std::nullptr_t) {}
+    replicated (this_type const& o) : block_(o.block_), slot_(detail::replica_slot() & (block_ ? block_->mask : 0)) { if (block_) add_(); }
+    replicated (this_type&& o) noexcept : block_(o.block_), slot_(o.slot_) { o.block_ = nullptr; }
+
+    this_type& operator=(this_type const& o) { this_type(o).swap(*this); return *this; }
+    this_type& operator=(this_type&& o) noexcept { this_type(std::move(o)).swap(*this); return *this; }
+
+    template<typename... arg_types>
+    replicated (detail::in_place_type, arg_types&&... args)
+    {
+        emplace<impl_type>(std::forward<arg_types>(args)...);
+    }
+
+    template<typename derived_type, typename... arg_types>
+    void
+    emplace(arg_types&&... args)
+    {
+        static_assert(std::is_copy_constructible<derived_type>::value, "Replicated implementations must be copy-constructible");
+
+        this_type(block_type::template make<derived_type>(std::forward<arg_types>(args)...)).swap(*this);
+    }
+
+    // Applies 'change' (a callable taking 'impl_type&') to a copy of the implementation
+    // and publishes the copy to all replicas. Nothing is published if 'change' or a copy throws.
+    template<typename function_type>
+    void
+    update(function_type&& change)
+    {
+        BOOST_ASSERT(block_);
+
+        block_type&                     b = *block_;
+        std::lock_guard<std::mutex>  lock (b.mutex);
+        std::vector<impl_type*>     fresh;
+
+        try
+        {
+            fresh.reserve(b.mask + 1);
+            fresh.push_back(b.clone(b.slot(0).replica.load(std::memory_order_relaxed)));
+
+            change(*fresh.front());
+
+            for (unsigned k = 1; k <= b.mask; ++k)
+                fresh.push_back(b.clone(fresh.front()));
+
+            b.retired.reserve(b.retired.size() + fresh.size());
+        }
+        catch (...)
+        {
+            for (impl_type* p : fresh) b.destroy(p);
+            throw;
+        }
+        for (unsigned k = 0; k <= b.mask; ++k)
+            b.retired.push_back(b.slot(k).replica.exchange(fresh[k], std::memory_order_acq_rel));
+
+        // The oldest generation is no longer read (see 'retained').
+        if (b.retired.size() > retained * fresh.size())
+        {
+            for (size_t k = 0; k < fresh.size(); ++k) b.destroy(b.retired[k]);
+
+            b.retired.erase(b.retired.begin(), b.retired.begin() + fresh.size());
+        }
+    }
+
+    bool operator==(this_type const& o) const { return block_ == o.block_; }
+    bool operator!=(this_type const& o) const { return block_ != o.block_; }
+    bool operator< (this_type const& o) const { return block_ <  o.block_; }
+    void      swap (this_type& o) noexcept { std::swap(block_, o.block_); std::swap(slot_, o.slot_); }
+
+    impl_type const* get () const { return block_ ? block_->slot(detail::replica_slot() & block_->mask).replica.load(std::memory_order_acquire) : nullptr; }
+    bool         is_null () const { return !block_; }
+
+    // Approximate when used concurrently (as std::shared_ptr::use_count()).
+    long
+    use_count() const
+    {
+        long count = 0;
+
+        if (block_)
+            for (unsigned k = 0; k <= block_->mask; ++k)
+                count += block_->slot(k).count.load(std::memory_order_relaxed);
+
+        return count;
+    }
+
+    private:
+
+    struct alignas(64) slot_type // One cache line (at least) per slot.
+    {
+        std::atomic<long>        count { 0 }; // Handles counted in this slot.
+        std::atomic<impl_type*> replica { nullptr };
+    };
+
+    struct alignas(64) block_type
+    {
+        std::atomic<long>     slots { 1 }; // The slots with handles (plus pending releases).
+        unsigned               mask;
+        void      (*destroy) (impl_type*);
+        impl_type*  (*clone) (impl_type const*); // Into a new replica allocation.
+        std::mutex            mutex;  // Serializes update().
+        std::vector<impl_type*> retired; // Superseded replicas (possibly still read). Oldest first.
+
+        slot_type& slot (unsigned k) { return reinterpret_cast<slot_type*>(this + 1)[k]; }
+
+        // The new block is counted in this thread's slot.
+        template<typename derived_type, typename... arg_types>
+        static this_type
+        make(arg_types&&... args)
+        {
+            unsigned const    count = detail::replica_count();
+            void* const      memory = boost::alignment::aligned_alloc(alignof(block_type), sizeof(block_type) + count * sizeof(slot_type));
+
+            if (!memory) throw std::bad_alloc();
+
+            block_type* b = ::new (memory) block_type();
+
+            b->mask = count - 1;
+            b->destroy = [](impl_type* p){ derived_type* d = static_cast<derived_type*>(p); d->~derived_type(); boost::alignment::aligned_free(d); };
+            b->clone = [](impl_type const* p) -> impl_type*
+            {
+                void* memory = detail::replica_alloc(sizeof(derived_type));
+
+                try { return ::new (memory) derived_type(*static_cast<derived_type const*>(p)); }
+                catch (...) { boost::alignment::aligned_free(memory); throw; }
+            };
+
+            for (unsigned k = 0; k < count; ++k)
+                ::new (&b->slot(k)) slot_type();
+
+            this_type result (nullptr);
+
+            result.block_ = b; // From now on, released (with its replicas) by 'result'.
+            result.slot_ = detail::replica_slot() & b->mask;
+            b->slot(result.slot_).count.store(1, std::memory_order_relaxed);
+
+            void*           first = detail::replica_alloc(sizeof(derived_type));
+            derived_type* replica = nullptr;
+
+            try { replica = ::new (first) derived_type(std::forward<arg_types>(args)...); }
+            catch (...) { boost::alignment::aligned_free(first); throw; }
+
+            b->slot(0).replica.store(replica, std::memory_order_relaxed); // Published with the handle.
+
+            for (unsigned k = 1; k < count; ++k)
+                b->slot(k).replica.store(b->clone(replica), std::memory_order_relaxed);
+
+            return result;
+        }
+
+        void
+        release()
+        {
+            for (unsigned k = 0; k <= mask; ++k)
+                if (impl_type* p = slot(k).replica.load(std::memory_order_relaxed))
+                    destroy(p);
+
+            for (impl_type* p : retired)
+                destroy(p);
+
+            this->~block_type();
+            boost::alignment::aligned_free(this);
+        }
+    };
+
+    // The caller holds a reference. Then, the object-wide count does not drop to zero meanwhile.
+    void
+    add_()
+    {
+        slot_type& s = block_->slot(slot_);
+        long       n = s.count.load(std::memory_order_relaxed);
+
+        for (;;)
+        {
+            if (n)
+            {
+                if (s.count.compare_exchange_weak(n, n + 1, std::memory_order_relaxed))
+                    return;
+                continue;
+            }
+            // The first handle of the slot: counted object-wide before it is seen in the slot.
+            block_->slots.fetch_add(1, std::memory_order_relaxed);
+
+            if (s.count.compare_exchange_strong(n, 1, std::memory_order_acq_rel))
+                return;
+
+            block_->slots.fetch_sub(1, std::memory_order_relaxed); // Beaten by another thread.
+        }
+    }
+
+    void
+    release_()
+    {
+        if (!block_) return;
+
+        if (block_->slot(slot_).count.fetch_sub(1, std::memory_order_acq_rel) == 1)
+            if (block_->slots.fetch_sub(1, std::memory_order_acq_rel) == 1)
+                block_->release();
+
+        block_ = nullptr;
+    }
+
+    block_type* block_ = nullptr;
+    unsigned     slot_ = 0;
+};
+
+template<typename impl_type> constexpr unsigned impl_ptr_policy::replicated<impl_type>::retained;
+
+#endif // IMPL_PTR_DETAIL_REPLICATED_HPP
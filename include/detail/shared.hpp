@@ -5,6 +5,7 @@
 #ifndef IMPL_PTR_DETAIL_SHARED_HPP
 #define IMPL_PTR_DETAIL_SHARED_HPP
 
+#include <boost/compressed_pair.hpp>
 #include "./detail.hpp"
 
 namespace impl_ptr_policy
@@ -12,30 +13,101 @@ namespace impl_ptr_policy
     template<typename, typename...> struct shared;
 }
 
+namespace detail
+{
+    template<typename impl_type, typename... more_types>
+    using shared_allocator = typename std::allocator_traits<
+                             typename types<more_types..., std::allocator<impl_type>>::first_type
+                             >::template rebind_alloc<impl_type>;
+}
+
 template<typename impl_type, typename... more_types>
-struct impl_ptr_policy::shared : std::shared_ptr<impl_type>
+struct impl_ptr_policy::shared
 {
-    using  allocator = typename std::conditional<
-                       1 <= sizeof...(more_types),
-                       typename detail::types<more_types...>::first_type,
-                       std::allocator<impl_type>>::type;
-    using alloc_type = typename std::allocator_traits<allocator>::template rebind_alloc<impl_type>;
-    using   base_ref = std::shared_ptr<impl_type>&;
+    using    this_type = shared;
+    using    allocator = typename std::conditional<
+                         1 <= sizeof...(more_types),
+                         typename detail::types<more_types...>::first_type,
+                         std::allocator<impl_type>>::type;
+    using   alloc_type = detail::shared_allocator<impl_type, more_types...>;
+    using alloc_traits = std::allocator_traits<alloc_type>;
+    using     ptr_type = std::shared_ptr<impl_type>;
+    using    weak_type = std::weak_ptr<impl_type>; // For weak_impl_ptr.
+
+    // std::shared_ptr is a pair of pointers with no self-references.
+    using trivially_relocatable = detail::relocatable_allocator<alloc_type>;
 
     template<typename derived_type, typename... arg_types>
     void
     emplace(arg_types&&... args)
     {
-        base_ref(*this) = std::allocate_shared<derived_type>(alloc_type(), std::forward<arg_types>(args)...);
+        ptr() = std::allocate_shared<derived_type>(get_allocator(), std::forward<arg_types>(args)...);
     }
 
     shared(std::nullptr_t) {}
+    shared(std::allocator_arg_t, alloc_type const& a, std::nullptr_t) : impl_(a) {}
 
     template<typename... arg_types>
     shared(detail::in_place_type, arg_types&&... args)
     {
         emplace<impl_type>(std::forward<arg_types>(args)...);
     }
+    template<typename... arg_types>
+    shared(std::allocator_arg_t, alloc_type const& a, detail::in_place_type, arg_types&&... args)
+    :
+        impl_(a)
+    {
+        emplace<impl_type>(std::forward<arg_types>(args)...);
+    }
+
+    // The implementation is shared. The allocator (only used for the next emplace())
+    // follows the same propagation rules as std containers.
+    shared (this_type&&) =default;
+    shared (this_type const& o)
+    :
+        impl_(o.ptr(), alloc_traits::select_on_container_copy_construction(o.allocator_()))
+    {}
+    this_type&
+    operator=(this_type const& o)
+    {
+        ptr() = o.ptr();
+        detail::propagate_allocator(allocator_(), o.allocator_(), typename alloc_traits::propagate_on_container_copy_assignment());
+        return *this;
+    }
+    this_type&
+    operator=(this_type&& o) noexcept
+    {
+        ptr() = std::move(o.ptr());
+        detail::propagate_allocator(allocator_(), o.allocator_(), typename alloc_traits::propagate_on_container_move_assignment());
+        return *this;
+    }
+
+    bool operator==(this_type const& o) const { return ptr() == o.ptr(); }
+    bool operator!=(this_type const& o) const { return ptr() != o.ptr(); }
+    bool operator< (this_type const& o) const { return ptr()  < o.ptr(); }
+
+    void
+    swap(this_type& o) noexcept
+    {
+        ptr().swap(o.ptr());
+        detail::swap_allocator(allocator_(), o.allocator_(), typename alloc_traits::propagate_on_container_swap());
+    }
+
+    weak_type        weak () const { return ptr(); }
+    void             lock (weak_type const& w) { ptr() = w.lock(); }
+    impl_type*        get () const { return ptr().get(); }
+    long        use_count () const { return ptr().use_count(); }
+    alloc_type get_allocator () const { return allocator_(); }
+
+    private:
+
+    ptr_type&               ptr ()       { return impl_.first(); }
+    ptr_type const&         ptr () const { return impl_.first(); }
+    alloc_type&       allocator_ ()       { return impl_.second(); }
+    alloc_type const& allocator_ () const { return impl_.second(); }
+
+    // A stateless allocator takes no space, i.e. the policy stays the size of std::shared_ptr.
+    boost::compressed_pair<ptr_type, alloc_type> impl_;
 };
 
 #endif // IMPL_PTR_DETAIL_SHARED_HPP
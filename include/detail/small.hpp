@@ -0,0 +1,210 @@
+// Copyright (c) 2008 Vladimir Batov.
+// Use, modification and distribution are subject to the Boost Software License,
+// Version 1.0. See http://www.boost.org/LICENSE_1_0.txt.
+
+#ifndef IMPL_PTR_DETAIL_SMALL_HPP
+#define IMPL_PTR_DETAIL_SMALL_HPP
+
+#include "./inplace.hpp"
+
+// Small-buffer policy: in-place storage with a heap fall-back.
+//
+//     struct Item : boost::impl_ptr<Item, policy::small, policy::storage<32>> { ... };
+//
+// 1) Implementations (including derived ones passed to emplace<derived>()) fitting the
+//    storage and nothrow-movable are constructed in place. Larger (or over-aligned or
+//    throwing on move) ones are allocated from the heap (with an optional stateless
+//    allocator as the 3rd policy argument). Then, a rare large variant does not break
+//    the build as with policy::inplace.
+// 2) The handle keeps the pointer to the implementation, in place or not. Then, get()
+//    is branch-free. An in-place implementation also keeps the operations of its actual
+//    type (as counted_header). Then, a derived one is copied and moved as such. Moving an in-place implementation re-points the pointer. Moving
+//    a heap one hands the pointer over. Then, moves and swap are noexcept (e.g. for
+//    std::vector to move rather than copy on reallocation).
+// 3) Value semantics as policy::copied. A copy of an in-place implementation is in place
+//    (of the same type), a copy of a heap one is on the heap (of the base type, as copied). A moved-from handle is null (as with copied).
+// 4) The allocator is re-created (default-constructed) for every allocation. Then, only
+//    stateless allocators are supported.
+
+namespace detail
+{
+    template<typename, typename, typename> struct small;
+}
+
+namespace impl_ptr_policy
+{
+    template<typename impl_type, typename size_type, typename allocator =std::allocator<void>>
+    using small = detail::small<impl_type, size_type, allocator>;
+}
+
+template<typename impl_type, typename size_type, typename allocator>
+struct detail::small
+{
+    using        this_type = small;
+    using     storage_type = boost::aligned_storage<size_type::size, size_type::alignment>;
+    using       heap_traits = traits::copyable<impl_type, allocator>;
+    using    heap_alloc_type = typename heap_traits::alloc_type;
+
+    // The operations of the type actually constructed in place (possibly derived).
+    struct ops_type
+    {
+        void (*copy)    (void*, impl_type const&);
+        void (*move)    (void*, impl_type&); // Nothrow (see emplace()).
+        void (*assign)  (impl_type*, impl_type const&);
+        void (*destroy) (impl_type*);
+        bool      base;  // Of impl_type itself.
+    };
+    template<typename derived_type> struct ops_of;
+
+   ~small () { reset(); }
+
+    small (std::nullptr_t) {}
+    small (this_type const& o) { copy_(o); }
+    small (this_type&& o) noexcept { move_(o); }
+
+    template<typename... arg_types>
+    small (detail::in_place_type, arg_types&&... args)
+    {
+        emplace<impl_type>(std::forward<arg_types>(args)...);
+    }
+
+    this_type&
+    operator=(this_type const& o)
+    {
+        // Assigned in place when of the same type. A heap implementation is copied as the
+        // base anyway. Then, it is assigned to an in-place base too.
+        bool const assignable = ops_ == o.ops_ || (ops_ && ops_->base && !o.ops_);
+
+        /**/ if (this == &o);
+        else if (impl_ && o.impl_ && !ops_) heap_traits::assign(impl_, *o.impl_);
+        else if (impl_ && o.impl_ && assignable) ops_->assign(impl_, *o.impl_);
+        else { reset(); copy_(o); }
+
+        return *this;
+    }
+    this_type&
+    operator=(this_type&& o) noexcept
+    {
+        if (this != &o)
+        {
+            reset();
+            move_(o);
+        }
+        return *this;
+    }
+
+    template<typename derived_type, typename... arg_types>
+    void
+    emplace(arg_types&&... args)
+    {
+        // Moved with the operations of derived_type (ops_of).
+        using fits = std::integral_constant<bool,
+                         sizeof(derived_type) <= sizeof(storage_type) &&
+                         alignof(storage_type) % alignof(derived_type) == 0 &&
+                         std::is_nothrow_move_constructible<derived_type>::value>;
+        reset();
+        construct_<derived_type>(fits(), std::forward<arg_types>(args)...);
+    }
+
+    bool operator< (this_type const& o) const { return impl_ < o.impl_; }
+    void      swap (this_type& o) noexcept
+    {
+        this_type tmp (std::move(o));
+
+        o     = std::move(*this);
+        *this = std::move(tmp);
+    }
+    impl_type* get () const { return impl_; }
+    long use_count () const { return 1; }
+
+    // Whether the implementation lives in the handle. For diagnostics and tests.
+    bool in_place () const { return inplace_(); }
+
+    private:
+
+    bool inplace_ () const { return ops_; }
+
+    template<typename derived_type, typename... arg_types>
+    void
+    construct_(std::true_type /*fits*/, arg_types&&... args)
+    {
+        impl_ = ::new (storage_.address()) derived_type(std::forward<arg_types>(args)...);
+        ops_  = &ops_of<derived_type>::table;
+    }
+    template<typename derived_type, typename... arg_types>
+    void
+    construct_(std::false_type /*fits*/, arg_types&&... args)
+    {
+        impl_ = heap_traits::template make<derived_type>(
+                    heap_alloc_type(), detail::in_place_type(), std::forward<arg_types>(args)...).release();
+    }
+
+    void
+    copy_(this_type const& o)
+    {
+        if (!o.impl_) return;
+
+        if (o.inplace_())
+        {
+            o.ops_->copy(storage_.address(), *o.impl_);
+            impl_ = static_cast<impl_type*>(storage_.address());
+            ops_  = o.ops_;
+        }
+        else impl_ = heap_traits::make(heap_alloc_type(), *o.impl_).release();
+    }
+    // In-place implementations are nothrow-movable (see emplace()).
+    void
+    move_(this_type& o) noexcept
+    {
+        if (!o.impl_) return;
+
+        if (o.inplace_())
+        {
+            o.ops_->move(storage_.address(), *o.impl_);
+            impl_ = static_cast<impl_type*>(storage_.address());
+            ops_  = o.ops_;
+            o.reset();
+        }
+        else std::swap(impl_, o.impl_); // Heap implementations are handed over.
+    }
+    void
+    reset()
+    {
+        impl_type* p = impl_;
+
+        if (!p) return;
+
+        ops_type const* ops = ops_;
+
+        impl_ = nullptr;
+        ops_  = nullptr;
+
+        if (ops) ops->destroy(p);
+        else     { heap_alloc_type a; heap_traits::destroy(a, p); }
+    }
+
+    storage_type     storage_;
+    impl_type*          impl_ = nullptr;
+    ops_type const*      ops_ = nullptr; // Null on the heap.
+};
+
+template<typename impl_type, typename size_type, typename allocator>
+template<typename derived_type>
+struct detail::small<impl_type, size_type, allocator>::ops_of
+{
+    using derived = derived_type;
+
+    static void    copy (void* p, impl_type const& from) { ::new (p) derived(static_cast<derived const&>(from)); }
+    static void    move (void* p, impl_type&       from) { ::new (p) derived(std::move(static_cast<derived&>(from))); }
+    static void  assign (impl_type* p, impl_type const& from) { *static_cast<derived*>(p) = static_cast<derived const&>(from); }
+    static void destroy (impl_type* p) { static_cast<derived*>(p)->~derived(); }
+
+    static constexpr ops_type table = { &copy, &move, &assign, &destroy, std::is_same<derived, impl_type>::value };
+};
+
+template<typename impl_type, typename size_type, typename allocator>
+template<typename derived_type>
+constexpr typename detail::small<impl_type, size_type, allocator>::ops_type
+detail::small<impl_type, size_type, allocator>::ops_of<derived_type>::table;
+
+#endif // IMPL_PTR_DETAIL_SMALL_HPP
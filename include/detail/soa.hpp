@@ -0,0 +1,323 @@
+// Copyright (c) 2008 Vladimir Batov.
+// Use, modification and distribution are subject to the Boost Software License,
+// Version 1.0. See http://www.boost.org/LICENSE_1_0.txt.
+
+#ifndef IMPL_PTR_DETAIL_SOA_HPP
+#define IMPL_PTR_DETAIL_SOA_HPP
+
+#include "./relocate.hpp"
+#include <boost/align/aligned_alloc.hpp>
+#include <boost/align/assume_aligned.hpp>
+#include <boost/fusion/include/at_c.hpp>
+#include <boost/fusion/include/size.hpp>
+#include <boost/fusion/include/value_at.hpp>
+#include <algorithm>
+#include <iterator>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+// Structure-of-arrays collection: every field of the implementations in its own array.
+//
+//     template<> struct boost::impl_ptr<Body>::implementation { double x, v; ... };
+//     BOOST_FUSION_ADAPT_STRUCT(boost::impl_ptr<Body>::implementation, x, v) // The fields, once.
+//
+//     boost::impl_soa<Body> bodies (items.begin(), items.end());
+//
+//     double*       x = bodies.column<0>().data(); // Aligned and contiguous.
+//     double const* v = bodies.column<1>().data();
+//
+//     for (size_t k = 0; k < bodies.size(); ++k) x[k] += v[k] * dt; // Vectorizes.
+//
+//     Body body = bodies[5];          // Gathered into a Pimpl.
+//     bodies[5] = body;               // Scattered.
+//     bodies[5].get<0>() = 1;         // One field.
+//
+// 1) Only usable where impl_ptr<user_type>::implementation and its Boost.Fusion adaptation
+//    are visible. The loops over the fields are written against the implementation anyway.
+// 2) The adapted fields are the state of the elements. The implementation is constructible
+//    from them in order (impl_type{ field0, field1, ... }). That is how elements are gathered.
+// 3) Elements are accessed through proxies: get<I>() for a field, conversion to user_type
+//    (gathered into an independent Pimpl) and assignment from user_type (scattered).
+// 4) Every column is aligned to a cache line (also the widest vector registers). Columns
+//    and proxies are invalidated on growth as with std::vector. Move-only container.
+
+namespace detail
+{
+    template<typename field_type>
+    struct soa_column
+    {
+        using value_type = typename std::remove_const<field_type>::type;
+        using   iterator = field_type*;
+
+        soa_column (field_type* data, size_t size) : data_(data), size_(size) {}
+
+        field_type*     data () const { field_type* p = data_; BOOST_ALIGN_ASSUME_ALIGNED(p, 64); return p; }
+        size_t          size () const { return size_; }
+        iterator       begin () const { return data(); }
+        iterator         end () const { return data() + size_; }
+        field_type& operator[] (size_t k) const { BOOST_ASSERT(k < size_); return data_[k]; }
+
+        private:
+
+        field_type* data_;
+        size_t      size_;
+    };
+
+    // The element 'k' of 'soa_type' (impl_soa or impl_soa const).
+    template<typename soa_type>
+    struct soa_element
+    {
+        using user_type = typename std::remove_const<soa_type>::type::user_type;
+
+        soa_element (soa_type& soa, size_t k) : soa_(soa), k_(k) {}
+
+        template<size_t I>
+        auto get() const -> decltype(std::declval<soa_type&>().template column<I>()[0]) { return soa_.template column<I>()[k_]; }
+
+        operator user_type () const { return soa_.gather_(k_); }
+
+        soa_element const& operator=(user_type const& u) const { soa_.scatter_(k_, *u); return *this; }
+        soa_element const& operator=(soa_element const& o) const { soa_.scatter_(k_, o.soa_, o.k_); return *this; }
+
+        private:
+
+        soa_type& soa_;
+        size_t      k_;
+    };
+}
+
+template<typename user_type_>
+struct impl_soa
+{
+    using     user_type = user_type_;
+    using impl_ptr_type = typename user_type::impl_ptr_type;
+    using     impl_type = typename impl_ptr_type::impl_type;
+    using     size_type = size_t;
+    using     reference = detail::soa_element<impl_soa>;
+    using const_reference = detail::soa_element<impl_soa const>;
+
+    template<size_t I>
+    using field_type = typename boost::fusion::result_of::value_at_c<impl_type, I>::type;
+
+    static constexpr size_t num_fields = boost::fusion::result_of::size<impl_type>::value;
+    static constexpr size_t  alignment = 64;
+
+   ~impl_soa () { clear(); deallocate_(); }
+    impl_soa () =default;
+    impl_soa (impl_soa const&) =delete;
+    impl_soa (impl_soa&& o) noexcept : size_(o.size_), capacity_(o.capacity_)
+    {
+        std::copy(o.columns_, o.columns_ + num_fields, columns_);
+        std::fill(o.columns_, o.columns_ + num_fields, nullptr);
+        o.size_ = o.capacity_ = 0;
+    }
+    impl_soa& operator=(impl_soa&& o) noexcept { impl_soa(std::move(o)).swap(*this); return *this; }
+
+    template<typename iterator>
+    impl_soa(iterator first, iterator last)
+    {
+        reserve(std::distance(first, last));
+
+        for (; first != last; ++first)
+            push_back(*first);
+    }
+
+    void
+    swap(impl_soa& o) noexcept
+    {
+        std::swap_ranges(columns_, columns_ + num_fields, o.columns_);
+        std::swap(size_, o.size_);
+        std::swap(capacity_, o.capacity_);
+    }
+
+    size_type     size () const { return size_; }
+    size_type capacity () const { return capacity_; }
+    bool         empty () const { return !size_; }
+
+    reference       operator[] (size_type k)       { BOOST_ASSERT(k < size_); return reference(*this, k); }
+    const_reference operator[] (size_type k) const { BOOST_ASSERT(k < size_); return const_reference(*this, k); }
+
+    template<size_t I> detail::soa_column<field_type<I>>       column ()       { return { data_<I>(), size_ }; }
+    template<size_t I> detail::soa_column<field_type<I> const> column () const { return { data_<I>(), size_ }; }
+
+    void
+    reserve(size_type num)
+    {
+        if (capacity_ < num)
+            grow_(num);
+    }
+
+    // The fields of the implementation of 'u' (copied).
+    void
+    push_back(user_type const& u)
+    {
+        BOOST_ASSERT(u);
+
+        impl_type const& impl = *u; // Const: the fields copied, not moved from 'u' (shallow constness).
+
+        emplace_(impl);
+    }
+
+    template<typename... arg_types>
+    void
+    emplace_back(arg_types&&... args)
+    {
+        impl_type impl (std::forward<arg_types>(args)...);
+
+        emplace_(impl); // The fields moved.
+    }
+
+    void pop_back () { BOOST_ASSERT(size_); destroy_(--size_); }
+
+    void
+    clear()
+    {
+        for (; size_; destroy_(--size_));
+    }
+
+    private:
+
+    template<typename> friend struct detail::soa_element;
+
+    using indices = std::make_index_sequence<num_fields>;
+
+    // f(std::integral_constant<size_t, I>()) for every field.
+    template<typename function_type, size_t... I>
+    static void
+    for_each_field_(function_type&& f, std::index_sequence<I...>)
+    {
+        using expand = int[];
+
+        (void) expand { 0, (f(std::integral_constant<size_t, I>()), 0)... };
+    }
+    template<typename function_type> static void for_each_field_ (function_type&& f) { for_each_field_(f, indices()); }
+
+    template<size_t I> field_type<I>* data_ () const { return static_cast<field_type<I>*>(columns_[I]); }
+
+    // impl_type& (the fields moved) or impl_type const& (copied).
+    template<typename impl_ref>
+    void
+    emplace_(impl_ref& impl)
+    {
+        if (size_ == capacity_)
+            grow_(std::max(size_type(16), 2 * capacity_));
+
+        size_type done = 0;
+
+        try
+        {
+            for_each_field_([&](auto i)
+            {
+                using field = field_type<decltype(i)::value>;
+
+                ::new (data_<decltype(i)::value>() + size_) field(std::move(boost::fusion::at_c<decltype(i)::value>(impl)));
+                ++done;
+            });
+        }
+        catch (...)
+        {
+            for_each_field_([&](auto i)
+            {
+                using field = field_type<decltype(i)::value>;
+
+                if (decltype(i)::value < done)
+                    data_<decltype(i)::value>()[size_].~field();
+            });
+            throw;
+        }
+        ++size_;
+    }
+
+    void
+    destroy_(size_type k)
+    {
+        for_each_field_([&](auto i)
+        {
+            using field = field_type<decltype(i)::value>;
+
+            data_<decltype(i)::value>()[k].~field();
+        });
+    }
+
+    template<size_t... I>
+    user_type
+    gather_(size_type k, std::index_sequence<I...>) const
+    {
+        static_assert(sizeof(user_type) == sizeof(impl_ptr_type), "Unsafe to cast");
+
+        return std::move(static_cast<user_type&&>(impl_ptr_type(impl_ptr_type::in_place, impl_type{ data_<I>()[k]... })));
+    }
+    user_type gather_ (size_type k) const { return gather_(k, indices()); }
+
+    void
+    scatter_(size_type k, impl_type const& impl)
+    {
+        for_each_field_([&](auto i) { data_<decltype(i)::value>()[k] = boost::fusion::at_c<decltype(i)::value>(impl); });
+    }
+    void
+    scatter_(size_type k, impl_soa const& from, size_type from_k)
+    {
+        for_each_field_([&](auto i) { data_<decltype(i)::value>()[k] = from.data_<decltype(i)::value>()[from_k]; });
+    }
+
+    void
+    grow_(size_type num)
+    {
+        void* columns[num_fields] = {};
+
+        try
+        {
+            for_each_field_([&](auto i)
+            {
+                using field = field_type<decltype(i)::value>;
+
+                columns[decltype(i)::value] = boost::alignment::aligned_alloc(std::max(alignment, alignof(field)), num * sizeof(field));
+
+                if (!columns[decltype(i)::value])
+                    throw std::bad_alloc();
+            });
+        }
+        catch (...)
+        {
+            for (void* p : columns) boost::alignment::aligned_free(p);
+            throw;
+        }
+
+        for_each_field_([&](auto i)
+        {
+            using field = field_type<decltype(i)::value>;
+
+            field* from = data_<decltype(i)::value>();
+
+            boost::uninitialized_relocate(from, from + size_, static_cast<field*>(columns[decltype(i)::value]));
+        });
+
+        deallocate_();
+
+        std::copy(columns, columns + num_fields, columns_);
+        capacity_ = num;
+    }
+
+    void
+    deallocate_()
+    {
+        for (void*& p : columns_)
+            boost::alignment::aligned_free(p), p = nullptr;
+    }
+
+    void*    columns_[num_fields] = {};
+    size_type             size_ = 0;
+    size_type         capacity_ = 0;
+};
+
+template<typename user_type> constexpr size_t impl_soa<user_type>::num_fields;
+template<typename user_type> constexpr size_t impl_soa<user_type>::alignment;
+
+namespace boost
+{
+    template<typename user_type>
+    using impl_soa = ::impl_soa<user_type>;
+}
+
+#endif // IMPL_PTR_DETAIL_SOA_HPP
@@ -16,15 +16,21 @@ namespace impl_ptr_policy
 template<typename impl_type, typename allocator>
 struct impl_ptr_policy::unique
 {
-    using   this_type = unique;
-    using traits_type = detail::traits::unique<impl_type, allocator>;
-    using    ptr_type = typename traits_type::ptr_type;
+    using    this_type = unique;
+    using  traits_type = detail::traits::unique<impl_type, allocator>;
+    using     ptr_type = typename traits_type::ptr_type;
+    using   alloc_type = typename traits_type::alloc_type;
+    using alloc_traits = typename traits_type::alloc_traits;
+    using deleter_type = typename traits_type::deleter;
+
+    // The handle is a pointer (and an allocator). No self-references.
+    using trivially_relocatable = detail::relocatable_allocator<alloc_type>;
 
     template<typename derived_type, typename... arg_types>
     void
     emplace(arg_types&&... args)
     {
-        impl_ = traits_type::template make<derived_type>(detail::in_place_type(), std::forward<arg_types>(args)...);
+        impl_.reset(traits_type::template make<derived_type>(get_allocator(), detail::in_place_type(), std::forward<arg_types>(args)...).release());
     }
 
     template<typename... arg_types>
@@ -32,22 +38,87 @@ struct impl_ptr_policy::unique
     {
         emplace<impl_type>(std::forward<arg_types>(args)...);
     }
+    template<typename... arg_types>
+    unique(std::allocator_arg_t, alloc_type const& a, detail::in_place_type, arg_types&&... args)
+    :
+        impl_(nullptr, deleter_type(a))
+    {
+        emplace<impl_type>(std::forward<arg_types>(args)...);
+    }
 
    ~unique () = default;
     unique (std::nullptr_t) {}
+    unique (std::allocator_arg_t, alloc_type const& a, std::nullptr_t) : impl_(nullptr, deleter_type(a)) {}
 
     unique (this_type&& o) = default;
-    this_type& operator= (this_type&& o) { swap(o); return *this; }
+    this_type& operator= (this_type&& o)
+    noexcept(alloc_traits::propagate_on_container_move_assignment::value || alloc_traits::is_always_equal::value)
+    {
+        using propagate = typename alloc_traits::propagate_on_container_move_assignment;
+
+        // With non-propagating unequal allocators the implementation
+        // cannot change hands. Then, it is moved as a value.
+        if (propagate::value || get_allocator() == o.get_allocator()) swap_(o, propagate());
+        else move_value_(o);
+
+        return *this;
+    }
 
     unique (this_type const&) =delete;
     this_type& operator= (this_type const&) =delete;
 
     bool operator< (this_type const& o) const { return impl_ < o.impl_; }
-    void      swap (this_type& o) { std::swap(impl_, o.impl_); }
+    void      swap (this_type& o)
+    noexcept(alloc_traits::propagate_on_container_swap::value || alloc_traits::is_always_equal::value)
+    {
+        using propagate = typename alloc_traits::propagate_on_container_swap;
+
+        if (propagate::value || get_allocator() == o.get_allocator())
+            return swap_(o, propagate());
+
+        // Non-propagating unequal allocators. The implementations are swapped as values.
+        this_type tmp (std::allocator_arg, allocator_(), nullptr);
+
+        tmp.move_value_(o);
+        o.move_value_(*this);
+        swap_(tmp, std::false_type());
+    }
     impl_type* get () const { return const_cast<impl_type*>(boost::to_address(impl_.get())); }
     long use_count () const { return 1; }
 
-    private: ptr_type impl_;
+    alloc_type get_allocator () const { return allocator_(); }
+
+    // For containers keeping the implementations in their own storage (impl_vector).
+    // Gives up/takes over the implementation. Nothing is destroyed or deallocated.
+    impl_type* release () noexcept { return boost::to_address(impl_.release()); }
+    void         adopt (impl_type* p) noexcept { BOOST_ASSERT(!impl_); impl_.reset(std::pointer_traits<typename traits_type::pointer>::pointer_to(*p)); }
+
+    private:
+
+    alloc_type&       allocator_ ()       { return impl_.get_deleter().allocator(); }
+    alloc_type const& allocator_ () const { return impl_.get_deleter().allocator(); }
+
+    // The implementation of 'o' moved into a new allocation from this allocator.
+    void
+    move_value_(this_type& o)
+    {
+        if (!o.impl_) impl_.reset();
+        else impl_.reset(traits_type::make(allocator_(), std::move(*o.impl_)).release());
+    }
+
+    // Implementations are swapped without requiring the allocators be assignable.
+    template<typename propagate>
+    void
+    swap_(this_type& o, propagate)
+    {
+        auto p = impl_.release();
+
+        impl_.reset(o.impl_.release());
+        o.impl_.reset(p);
+        detail::swap_allocator(allocator_(), o.allocator_(), propagate());
+    }
+
+    ptr_type impl_;
 };
 
 #endif // IMPL_PTR_DETAIL_UNIQUE_HPP
@@ -0,0 +1,239 @@
+// Copyright (c) 2008 Vladimir Batov.
+// Use, modification and distribution are subject to the Boost Software License,
+// Version 1.0. See http://www.boost.org/LICENSE_1_0.txt.
+
+#ifndef IMPL_PTR_DETAIL_VECTOR_HPP
+#define IMPL_PTR_DETAIL_VECTOR_HPP
+
+#include "./relocate.hpp"
+#include <algorithm>
+#include <new>
+#include <vector>
+
+// A vector keeping the implementations themselves contiguously (in the order of the elements).
+//
+//     struct Point : boost::impl_ptr<Point, policy::copied> { ... };
+//
+//     struct Shape // Header. The implementation is not visible.
+//     {
+//         boost::impl_vector<Point> points;
+//     };
+//
+//     shape.points.emplace_back(x, y);               // Where impl_ptr<Point>::implementation is visible.
+//     for (Point const& p : shape.points) p.x();     // Anywhere.
+//
+// 1) For the policies owning their implementations exclusively (unique, copied and the
+//    policies based on them). The elements are the Pimpls (handles) of the contiguous
+//    implementations. Then, a scan reads two sequential streams (handles and implementations).
+// 2) The elements are accessed as 'user_type const&'. Copies of elements are independent
+//    Pimpls (copied semantics). The elements are only added, replaced and removed through
+//    the container.
+// 3) emplace_back()/push_back() are only usable where impl_ptr<user_type>::implementation is
+//    visible. All the other operations (including destruction, erase(), reserve()) are
+//    usable anywhere: the operations on the implementations are recorded by emplace_back().
+// 4) The implementations are relocated on growth and on erase(). Relocation is a memmove for
+//    trivially relocatable implementations, a move (expected not to throw) and a destruction
+//    otherwise. References to elements are invalidated as with std::vector.
+// 5) Only the implementation type itself (no derived types). Move-only container.
+
+namespace detail
+{
+    struct vector_ops
+    {
+        size_t                                      size;
+        void (*relocate) (void* first, size_t num, void* out);
+        void (*destroy)  (void* p);
+    };
+
+    template<typename impl_type>
+    struct vector_ops_for
+    {
+        static void
+        relocate(void* first, size_t num, void* out)
+        {
+            impl_type* from = static_cast<impl_type*>(first);
+
+            boost::uninitialized_relocate(from, from + num, static_cast<impl_type*>(out));
+        }
+        static void destroy (void* p) { static_cast<impl_type*>(p)->~impl_type(); }
+
+        static constexpr vector_ops operations = { sizeof(impl_type), &relocate, &destroy };
+    };
+
+    template<typename impl_type>
+    constexpr vector_ops vector_ops_for<impl_type>::operations;
+}
+
+template<typename user_type>
+struct impl_vector
+{
+    using impl_ptr_type = typename user_type::impl_ptr_type;
+    using     impl_type = typename impl_ptr_type::impl_type;
+    using   policy_type = typename impl_ptr_type::policy_type;
+    using   handle_list = std::vector<user_type>;
+    using    value_type = user_type;
+    using     reference = user_type const&;
+    using      iterator = typename handle_list::const_iterator;
+    using    size_type = size_t;
+
+   ~impl_vector () { clear(); ::operator delete(storage_); }
+    impl_vector () =default;
+    impl_vector (impl_vector const&) =delete;
+    impl_vector (impl_vector&& o) noexcept
+    :
+        handles_(std::move(o.handles_)), storage_(o.storage_), capacity_(o.capacity_), reserved_(o.reserved_), ops_(o.ops_)
+    {
+        o.handles_.clear();
+        o.storage_ = nullptr;
+        o.capacity_ = 0;
+    }
+    impl_vector& operator=(impl_vector&& o) noexcept { impl_vector(std::move(o)).swap(*this); return *this; }
+
+    void
+    swap(impl_vector& o) noexcept
+    {
+        handles_.swap(o.handles_);
+        std::swap(storage_, o.storage_);
+        std::swap(capacity_, o.capacity_);
+        std::swap(reserved_, o.reserved_);
+        std::swap(ops_, o.ops_);
+    }
+
+    iterator      begin () const { return handles_.begin(); }
+    iterator        end () const { return handles_.end(); }
+    size_type      size () const { return handles_.size(); }
+    size_type  capacity () const { return capacity_; }
+    bool          empty () const { return handles_.empty(); }
+    reference operator[] (size_type k) const { return handles_[k]; }
+    reference     front () const { return handles_.front(); }
+    reference      back () const { return handles_.back(); }
+
+    // Before the first emplace_back() (i.e. with the size of the implementation unknown yet),
+    // only recorded.
+    void
+    reserve(size_type num)
+    {
+        if (num <= capacity_) return;
+
+        handles_.reserve(num);
+
+        if (ops_) grow_(num);
+        else      reserved_ = std::max(reserved_, num);
+    }
+
+    template<typename... arg_types>
+    reference
+    emplace_back(arg_types&&... args)
+    {
+        using alloc_type = typename policy_type::alloc_type;
+
+        ops_ = &detail::vector_ops_for<impl_type>::operations;
+
+        handles_.push_back(impl_ptr_type::null());
+
+        size_type const       k = handles_.size() - 1;
+        bool const         full = k == capacity_;
+        size_type const     num = full ? std::max({ size_type(8), 2 * capacity_, reserved_ }) : capacity_;
+        void* const     storage = full ? ::operator new(num * sizeof(impl_type)) : storage_;
+        impl_type* const      p = static_cast<impl_type*>(storage) + k;
+        alloc_type            a;
+
+        // Constructed before the elements are relocated: 'args' may refer to one of them
+        // (as with v.push_back(v[0])).
+        try { policy_type::traits_type::emplace(a, p, std::forward<arg_types>(args)...); } // Also records the policy's operations.
+        catch (...)
+        {
+            handles_.pop_back();
+            if (full) ::operator delete(storage);
+            throw;
+        }
+
+        if (full) grow_(storage, num, k);
+
+        policy_(handles_.back()).adopt(p);
+
+        return handles_.back();
+    }
+
+    reference push_back (user_type const& u) { return emplace_back(*u); }
+    reference push_back (user_type&& u)      { return emplace_back(std::move(*u)); }
+
+    iterator
+    erase(iterator it)
+    {
+        size_type const k = it - handles_.begin();
+
+        destroy_(k);
+        relocate_(k + 1, handles_.size(), slot_(k));
+        handles_.erase(handles_.begin() + k);
+
+        return handles_.begin() + k;
+    }
+
+    void pop_back () { erase(end() - 1); }
+
+    void
+    clear()
+    {
+        for (size_type k = 0; k < handles_.size(); ++k)
+            destroy_(k);
+
+        handles_.clear();
+    }
+
+    private:
+
+    static policy_type& policy_ (user_type& u) { return static_cast<impl_ptr_type&>(u).impl_; }
+
+    void* slot_ (size_type k) const { return static_cast<char*>(storage_) + k * ops_->size; }
+
+    // Ends the implementation. The handle becomes null.
+    void
+    destroy_(size_type k)
+    {
+        ops_->destroy(policy_(handles_[k]).release());
+    }
+
+    // Relocates the implementations [first, last) to 'out' (forward) and re-points their handles.
+    void
+    relocate_(size_type first, size_type last, void* out)
+    {
+        if (first == last) return;
+
+        for (size_type k = first; k < last; ++k)
+            policy_(handles_[k]).release();
+
+        ops_->relocate(slot_(first), last - first, out);
+
+        for (size_type k = first; k < last; ++k)
+            policy_(handles_[k]).adopt(reinterpret_cast<impl_type*>(static_cast<char*>(out) + (k - first) * ops_->size));
+    }
+
+    void grow_ (size_type num) { grow_(::operator new(num * ops_->size), num, handles_.size()); }
+
+    // Moves the first 'count' implementations to 'storage' of 'num' slots.
+    void
+    grow_(void* storage, size_type num, size_type count)
+    {
+        relocate_(0, count, storage);
+
+        ::operator delete(storage_);
+
+        storage_  = storage;
+        capacity_ = num;
+    }
+
+    handle_list          handles_; // Null or adopting the implementation in its slot.
+    void*                storage_ = nullptr;
+    size_type           capacity_ = 0;
+    size_type           reserved_ = 0;
+    detail::vector_ops const* ops_ = nullptr;
+};
+
+namespace boost
+{
+    template<typename user_type>
+    using impl_vector = ::impl_vector<user_type>;
+}
+
+#endif // IMPL_PTR_DETAIL_VECTOR_HPP
@@ -0,0 +1,169 @@
+// Copyright (c) 2008 Vladimir Batov.
+// Use, modification and distribution are subject to the Boost Software License,
+// Version 1.0. See http://www.boost.org/LICENSE_1_0.txt.
+
+#ifndef IMPL_PTR_DETAIL_WEAK_HPP
+#define IMPL_PTR_DETAIL_WEAK_HPP
+
+#include "./detail.hpp"
+#include <boost/functional/hash.hpp>
+#include <list>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+// Non-owning references and evictable caches of shared implementations.
+//
+//     boost::weak_impl_ptr<Book> weak (book);
+//     Book                       copy = weak.lock(); // Null when the implementation is gone.
+//
+//     Book::Book(string const& title) : impl_ptr_type(nullptr)
+//     {
+//         static boost::impl_ptr_cache<Book> cache (100); // Keeps the 100 most recently used.
+//
+//         *this = cache.get(title, args); // Book constructed from 'args' when not there or gone.
+//     }
+//
+// 1) For the policies with weak references (policy::shared, policy::pmr_shared).
+//    The policy provides 'weak_type', weak() and lock(weak_type const&).
+// 2) impl_ptr_cache keeps weak references. Then, it does not keep implementations alive
+//    (unlike the unique-entry collection). The optional capacity keeps (strong references
+//    to) that many most recently used implementations alive, referenced or not.
+// 3) Entries of the released implementations are purged when the table doubles.
+// 4) impl_ptr_cache is thread-safe (one mutex). The evicted implementations are released
+//    outside the lock. get() is only usable where impl_ptr<user_type>::implementation is visible.
+
+template<typename user_type>
+struct weak_impl_ptr
+{
+    using impl_ptr_type = typename user_type::impl_ptr_type;
+    using   policy_type = typename impl_ptr_type::policy_type;
+    using     weak_type = typename policy_type::weak_type;
+
+    weak_impl_ptr () =default;
+    weak_impl_ptr (user_type const& u) : weak_(base_(u).impl_.weak()) {}
+
+    // The implementation if still alive. Null otherwise.
+    user_type
+    lock() const
+    {
+        user_type u = user_type::null();
+
+        base_(u).impl_.lock(weak_);
+        return u;
+    }
+
+    bool expired () const { return weak_.expired(); }
+    void   reset () { weak_.reset(); }
+
+    private:
+
+    static impl_ptr_type const& base_ (user_type const& u) { return u; }
+    static impl_ptr_type&       base_ (user_type& u)       { return u; }
+
+    weak_type weak_;
+};
+
+template<typename user_type, typename key_type =std::string, typename hash_type =boost::hash<key_type>>
+struct impl_ptr_cache
+{
+    // Unreferenced implementations kept alive: 'capacity' most recently used.
+    explicit impl_ptr_cache(size_t capacity =0) : capacity_(capacity) {}
+
+    // The implementation for the key. Constructed from 'args' when not there or released.
+    template<typename... arg_types>
+    user_type
+    get(key_type const& key, arg_types&&... args)
+    {
+        user_type evicted = user_type::null(); // Released after the lock.
+        std::lock_guard<std::mutex> lock (mutex_);
+        entry&                     found = map_[key];
+        user_type                 result = found.weak.lock();
+
+        if (!result)
+        {
+            result.emplace(std::forward<arg_types>(args)...);
+            found.weak = result;
+        }
+        touch_(found, result, evicted);
+        purge_();
+
+        return result;
+    }
+
+    // The implementation for the key. Null when not there or released.
+    user_type
+    find(key_type const& key)
+    {
+        std::lock_guard<std::mutex> lock (mutex_);
+        auto                       found = map_.find(key);
+
+        return found == map_.end() ? user_type::null() : found->second.weak.lock();
+    }
+
+    // The number of entries (including the released but not yet purged ones).
+    size_t size () const { std::lock_guard<std::mutex> lock (mutex_); return map_.size(); }
+
+    private:
+
+    struct entry;
+
+    using lru_type = std::list<std::pair<entry*, user_type>>;
+
+    struct entry
+    {
+        weak_impl_ptr<user_type>          weak;
+        typename lru_type::iterator        lru;
+        bool                            in_lru = false;
+    };
+
+    // Makes the entry the most recently used. Drops the least recently used beyond capacity.
+    void
+    touch_(entry& e, user_type const& u, user_type& evicted)
+    {
+        if (!capacity_) return;
+
+        if (e.in_lru) lru_.splice(lru_.begin(), lru_, e.lru);
+        else          lru_.emplace_front(&e, u);
+
+        e.lru = lru_.begin();
+        e.in_lru = true;
+
+        if (lru_.size() <= capacity_)
+            return;
+
+        lru_.back().first->in_lru = false;
+        evicted = std::move(lru_.back().second);
+        lru_.pop_back();
+    }
+
+    // Removes the entries of the released implementations (amortized).
+    void
+    purge_()
+    {
+        if (map_.size() < 2 * purged_) return;
+
+        for (auto it = map_.begin(); it != map_.end();)
+            if (it->second.weak.expired()) it = map_.erase(it);
+            else ++it;
+
+        purged_ = map_.size() < 16 ? 16 : map_.size();
+    }
+
+    mutable std::mutex                                  mutex_;
+    std::unordered_map<key_type, entry, hash_type>        map_; // Node-based: stable entry addresses.
+    lru_type                                              lru_;
+    size_t const                                     capacity_;
+    size_t                                             purged_ = 16;
+};
+
+namespace boost
+{
+    template<typename user_type>
+    using weak_impl_ptr = ::weak_impl_ptr<user_type>;
+
+    template<typename user_type, typename key_type =std::string, typename hash_type =boost::hash<key_type>>
+    using impl_ptr_cache = ::impl_ptr_cache<user_type, key_type, hash_type>;
+}
+
+#endif // IMPL_PTR_DETAIL_WEAK_HPP
@@ -6,9 +6,28 @@
 #define IMPL_PTR_HPP
 
 #include "./detail/shared.hpp"
+#include "./detail/local_shared.hpp"
+#include "./detail/intrusive.hpp"
+#include "./detail/biased.hpp"
+#include "./detail/replicated.hpp"
 #include "./detail/unique.hpp"
 #include "./detail/copied.hpp"
+#include "./detail/cow.hpp"
 #include "./detail/inplace.hpp"
+#include "./detail/small.hpp"
+#include "./detail/lazy.hpp"
+#include "./detail/region.hpp"
+#include "./detail/pool.hpp"
+#include "./detail/batch.hpp"
+#include "./detail/affine.hpp"
+#include "./detail/interned.hpp"
+#include "./detail/weak.hpp"
+#include "./detail/epoch.hpp"
+#include "./detail/relocate.hpp"
+#include "./detail/vector.hpp"
+#include "./detail/soa.hpp"
+#include <iterator>
+#include <vector>
 
 // C1. Always use the impl_ptr<user_type>::implementation specialization.
 //     That allows the developer to only declare/define one implementation:
@@ -25,6 +44,15 @@
 //     Trying to call this base::op==() for unique-based impl_ptr will fail to compile
 //     (no unique::op==()) and will indicate that the user forgot to declare
 //     T::operator==(T const&).
+// C3. Explicit instantiation.
+//     With many Pimpl types, the handle members are otherwise instantiated (and then
+//     discarded by the linker) in every translation unit using them. Instead,
+//         IMPL_PTR_EXTERN_TEMPLATE(Book, policy::shared); // In the header, after Book.
+//         IMPL_PTR_INSTANTIATE(Book, policy::shared);     // In the implementation file.
+//     instantiates them once, in the implementation file. The arguments are the ones
+//     of the impl_ptr base of the user type. The comparison operators (C2) are templates
+//     to be only instantiated for the policies supporting them. The policy needs to
+//     support all other operations (e.g. 'inplace' does not support op< and use_count).
 
 template<
     typename user_type,
@@ -55,20 +83,24 @@ struct impl_ptr
 
     static constexpr detail::in_place_type in_place {}; // Until C++17 with std::in_place
 
+    // The move operations are noexcept when the policy's are (e.g. for std::vector
+    // to move rather than copy on reallocation).
    ~impl_ptr()                           = default;
     impl_ptr(impl_ptr const&)            = default;
-    impl_ptr(impl_ptr&&)                 = default;
+    impl_ptr(impl_ptr&&)                 noexcept(std::is_nothrow_move_constructible<policy_type>::value) = default;
     impl_ptr& operator=(impl_ptr const&) = default;
-    impl_ptr& operator=(impl_ptr&&)      = default;
+    impl_ptr& operator=(impl_ptr&&)      noexcept(std::is_nothrow_move_assignable<policy_type>::value) = default;
 
-    bool         operator! () const { return !impl_.get(); }
-    explicit operator bool () const { return  impl_.get(); }
+    bool         operator! () const { return  detail::is_null(impl_); }
+    explicit operator bool () const { return !detail::is_null(impl_); }
 
-    bool operator==(user_type const& that) const { return impl_ == that.impl_; } //C2
-    bool operator!=(user_type const& that) const { return impl_ != that.impl_; } //C2
+    template<typename P =policy_type>
+    auto operator==(user_type const& that) const -> decltype(std::declval<P const&>() == std::declval<P const&>()) { return impl_ == that.impl_; } //C2
+    template<typename P =policy_type>
+    auto operator!=(user_type const& that) const -> decltype(std::declval<P const&>() != std::declval<P const&>()) { return impl_ != that.impl_; } //C2
     bool operator< (user_type const& that) const { return impl_  < that.impl_; }
 
-    void      swap (user_type& that) { impl_.swap(that.impl_); }
+    void      swap (user_type& that) noexcept(noexcept(std::declval<policy_type&>().swap(std::declval<policy_type&>()))) { impl_.swap(that.impl_); }
     long use_count () const { return impl_.use_count(); }
 
     template<typename derived_impl_type, typename... arg_types>
@@ -86,17 +118,67 @@ struct impl_ptr
         impl_.template emplace<impl_type>(std::forward<arg_types>(args)...);
     }
 
+    // Batch construction and cloning. With batch policies (policy::batch, policy::copied_batch),
+    // the implementations are allocated in one block. Otherwise, one by one. Only usable
+    // where impl_ptr<>::implementation is visible.
+    template<typename... arg_types>
+    static std::vector<user_type>
+    make_n(size_t count, arg_types const&... args)
+    {
+        static_assert(sizeof(user_type) == sizeof(impl_ptr_type), "Unsafe to cast");
+
+        std::vector<user_type>                           result;
+        detail::batch_scope<policy_type, impl_type> scope (count);
+
+        result.reserve(count);
+
+        for (size_t k = 0; k < count; ++k)
+            result.push_back(std::move(static_cast<user_type&&>(impl_ptr_type(in_place, args...))));
+
+        return result;
+    }
+    template<typename iterator>
+    static std::vector<user_type>
+    clone(iterator first, iterator last)
+    {
+        std::vector<user_type>                           result;
+        detail::batch_scope<policy_type, impl_type> scope (std::distance(first, last));
+
+        result.reserve(std::distance(first, last));
+
+        for (; first != last; ++first)
+            result.push_back(user_type(*first));
+
+        return result;
+    }
+
     // Access To the Implementation.
     // 1) These methods are public because they are only usable
     //    in the code where impl_ptr<>::implementation is visible.
     // 2) For better or worse the original deep-constness behavior has been changed
     //    to match std::shared_ptr et al to avoid questions, confusion, etc.
-    impl_type* operator->() const { BOOST_ASSERT(impl_.get()); return  impl_.get(); }
-    impl_type& operator *() const { BOOST_ASSERT(impl_.get()); return *impl_.get(); }
+    // 3) Policies may distinguish const and non-const access (e.g. copy-on-write:
+    //    policy::get() returns 'impl_type const*', policy::get_mutable() detaches).
+    // 4) Templates as impl_ptr<user_type> (with no policy) is instantiated for C1.
+    template<typename P =policy_type> auto operator->() const -> decltype( std::declval<P const&>().get()) { BOOST_ASSERT(impl_.get()); return  impl_.get(); }
+    template<typename P =policy_type> auto operator *() const -> decltype(*std::declval<P const&>().get()) { BOOST_ASSERT(impl_.get()); return *impl_.get(); }
+    template<typename P =policy_type> auto operator->()       -> decltype( detail::get_mutable(std::declval<P&>())) { BOOST_ASSERT(impl_.get()); return  detail::get_mutable(impl_); }
+    template<typename P =policy_type> auto operator *()       -> decltype(*detail::get_mutable(std::declval<P&>())) { BOOST_ASSERT(impl_.get()); return *detail::get_mutable(impl_); }
+
+    // Copy-on-write policies. Makes sure the implementation is not shared.
+    template<typename P =policy_type>
+    auto detach() -> decltype(std::declval<P&>().detach()) { impl_.detach(); }
+
+    // Replicated policies. Applies 'change' (taking 'impl_type&') to a copy and publishes it to every replica.
+    template<typename function_type, typename P =policy_type>
+    auto update(function_type&& change) -> decltype(std::declval<P&>().update(std::forward<function_type>(change))) { impl_.update(std::forward<function_type>(change)); }
 
     protected:
 
     template<typename, template<typename, typename...> class, typename...> friend struct impl_ptr;
+    template<typename> friend struct weak_impl_ptr;
+    template<typename> friend struct impl_vector;
+    template<typename> friend struct impl_soa;
 
     impl_ptr(std::nullptr_t) : impl_(nullptr) {}
 
@@ -106,6 +188,20 @@ struct impl_ptr
         impl_(in_place, std::forward<arg_types>(args)...)
     {}
 
+    // Allocator-extended constructors (the std::allocator_arg convention of std::tuple et al).
+    // The policy keeps the allocator instance and uses it for this and later allocations.
+    template<typename allocator_type>
+    impl_ptr(std::allocator_arg_t, allocator_type const& alloc, std::nullptr_t)
+    :
+        impl_(std::allocator_arg, alloc, nullptr)
+    {}
+
+    template<typename allocator_type, typename... arg_types>
+    impl_ptr(std::allocator_arg_t, allocator_type const& alloc, detail::in_place_type, arg_types&&... args)
+    :
+        impl_(std::allocator_arg, alloc, in_place, std::forward<arg_types>(args)...)
+    {}
+
     private: policy_type impl_;
 };
 
@@ -123,4 +219,7 @@ namespace boost
     struct is_impl_ptr<T, void_type<typename T::impl_ptr_type>> : true_type {};
 }
 
+#define IMPL_PTR_EXTERN_TEMPLATE(...) extern template struct ::impl_ptr<__VA_ARGS__> //C3
+#define IMPL_PTR_INSTANTIATE(...)            template struct ::impl_ptr<__VA_ARGS__> //C3
+
 #endif // IMPL_PTR_HPP
@@ -57,4 +57,50 @@ bool operator!=(my_allocator<T1> const&, my_allocator<T2> const&) throw()
     return false;
 }
 
+// Stateful allocator. Instances are equal when they draw from the same arena.
+// The arena only counts live allocations.
+struct arena
+{
+    int allocated = 0;
+};
+
+template <class T>
+struct arena_allocator
+{
+    using                             value_type = T;
+    using propagate_on_container_copy_assignment = std::true_type;
+    using propagate_on_container_move_assignment = std::true_type;
+    using            propagate_on_container_swap = std::true_type;
+
+    explicit arena_allocator(arena& a) throw() : arena_(&a) {}
+
+    template<typename other_type>
+    arena_allocator(arena_allocator<other_type> const& o) throw() : arena_(o.arena_) {}
+
+    T* allocate(size_t num)
+    {
+        ++arena_->allocated;
+        return (T*) ::operator new(num * sizeof(T));
+    }
+    void deallocate(T* p, size_t)
+    {
+        --arena_->allocated;
+        ::operator delete((void*) p);
+    }
+
+    arena* arena_;
+};
+
+template <class T1, class T2>
+bool operator==(arena_allocator<T1> const& a1, arena_allocator<T2> const& a2) throw()
+{
+    return a1.arena_ == a2.arena_;
+}
+
+template <class T1, class T2>
+bool operator!=(arena_allocator<T1> const& a1, arena_allocator<T2> const& a2) throw()
+{
+    return a1.arena_ != a2.arena_;
+}
+
 #endif // IMPL_PTR_TEST_ALLOCATOR_HPP
@@ -11,6 +11,8 @@ template<> struct boost::impl_ptr<Book>::implementation
     string author;
 };
 
+IMPL_PTR_INSTANTIATE(Book, policy::shared);
+
 Book::Book(string const& title, string const& author)
 :
     impl_ptr_type(in_place, title, author)
@@ -0,0 +1,12 @@
+#include "./test.hpp"
+
+template<> struct boost::impl_ptr<Handed>::implementation
+{
+    implementation (int k) : int_(k) {}
+
+    int int_;
+};
+
+Handed::Handed (int k) : impl_ptr_type(in_place, k) {}
+
+int Handed::value () const { return (*this)->int_; }
@@ -0,0 +1,12 @@
+#include "./test.hpp"
+
+template<> struct boost::impl_ptr<Allocated>::implementation
+{
+    implementation (int k) : int_(k) {}
+
+    int int_;
+};
+
+Allocated::Allocated (arena& a, int k) : impl_ptr_type(std::allocator_arg, arena_allocator<void>(a), in_place, k) {}
+
+int Allocated::value () const { return (*this)->int_; }
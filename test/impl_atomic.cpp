@@ -0,0 +1,16 @@
+#include "./test.hpp"
+
+namespace { std::atomic<int> live (0); }
+
+template<> struct boost::impl_ptr<Routes>::implementation
+{
+    implementation (int k) : int_(k) { ++live; }
+   ~implementation () { --live; }
+
+    int int_;
+};
+
+Routes::Routes (int k) : impl_ptr_type(in_place, k) {}
+
+int Routes::value () const { return (*this)->int_; }
+int Routes::instances () { return live; }
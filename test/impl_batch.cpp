@@ -0,0 +1,40 @@
+#include "./test.hpp"
+
+namespace { std::atomic<int> live (0); }
+
+template<> struct boost::impl_ptr<Batched>::implementation
+{
+    implementation (int k) : int_(k) { ++live; }
+    implementation (implementation const& o) : int_(o.int_) { ++live; }
+   ~implementation () { --live; }
+
+    implementation& operator=(implementation const&) =default;
+
+    int int_;
+};
+
+namespace
+{
+    struct AlignedImpl : boost::impl_ptr<Batched>::implementation
+    {
+        using base = boost::impl_ptr<Batched>::implementation;
+
+        AlignedImpl (int k, long double d) : base(k), long_double_(d) {}
+
+        long double long_double_;
+    };
+}
+
+Batched::Batched (int k) : impl_ptr_type(in_place, k) {}
+Batched::Batched (int k, long double d) : impl_ptr_type(null())
+{
+    emplace<AlignedImpl>(k, d);
+}
+
+int         Batched::value () const { return (*this)->int_; }
+void        Batched::value (int k) { (*this)->int_ = k; }
+char const* Batched::address () const { return reinterpret_cast<char const*>(&**this); }
+int         Batched::instances () { return live; }
+
+std::vector<Batched> Batched::make (size_t n, int k) { return make_n(n, k); }
+std::vector<Batched> Batched::copy (std::vector<Batched> const& v) { return clone(v.begin(), v.end()); }
@@ -0,0 +1,16 @@
+#include "./test.hpp"
+
+namespace { std::atomic<int> live (0); }
+
+template<> struct boost::impl_ptr<Session>::implementation
+{
+    implementation (int k) : int_(k) { ++live; }
+   ~implementation () { --live; }
+
+    int int_;
+};
+
+Session::Session (int k) : impl_ptr_type(in_place, k) {}
+
+int Session::value () const { return (*this)->int_; }
+int Session::instances () { return live; }
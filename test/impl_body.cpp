@@ -0,0 +1,72 @@
+#include "./test.hpp"
+#include <boost/fusion/include/adapt_struct.hpp>
+
+template<> struct boost::impl_ptr<Body>::implementation
+{
+    implementation (double x, double v, std::string const& name) : x(x), v(v), name(name) {}
+
+    double       x;
+    double       v;
+    std::string name;
+};
+
+BOOST_FUSION_ADAPT_STRUCT(boost::impl_ptr<Body>::implementation, x, v, name)
+
+Body::Body (double x, double v, std::string const& name) : impl_ptr_type(in_place, x, v, name) {}
+
+double             Body::x () const { return (*this)->x; }
+double             Body::v () const { return (*this)->v; }
+std::string const& Body::name () const { return (*this)->name; }
+
+std::vector<Body>
+Body::advance(std::vector<Body> const& bodies, double dt)
+{
+    boost::impl_soa<Body> soa (bodies.begin(), bodies.end());
+
+    double*       x = soa.column<0>().data();
+    double const* v = soa.column<1>().data();
+
+    for (size_t k = 0; k < soa.size(); ++k)
+        x[k] += v[k] * dt;
+
+    std::vector<Body> result;
+
+    for (size_t k = 0; k < soa.size(); ++k)
+        result.push_back(soa[k]);
+
+    return result;
+}
+
+std::vector<Body>
+Body::reverse(std::vector<Body> const& bodies)
+{
+    boost::impl_soa<Body> soa;
+
+    for (Body const& body : bodies)
+        soa.emplace_back(body.x(), body.v(), body.name()); // Grows, relocating the columns.
+
+    for (size_t k = 0, n = soa.size(); k < n / 2; ++k)
+    {
+        Body first = soa[k];
+
+        soa[k] = soa[n - 1 - k];
+        soa[n - 1 - k] = first;
+    }
+
+    std::vector<Body> result;
+
+    for (size_t k = 0; k < soa.size(); ++k)
+        result.push_back(soa[k]);
+
+    return result;
+}
+
+bool
+Body::aligned(std::vector<Body> const& bodies)
+{
+    boost::impl_soa<Body> soa (bodies.begin(), bodies.end());
+
+    auto is_aligned = [](void const* p) { return reinterpret_cast<uintptr_t>(p) % boost::impl_soa<Body>::alignment == 0; };
+
+    return is_aligned(soa.column<0>().data()) && is_aligned(soa.column<1>().data()) && is_aligned(soa.column<2>().data());
+}
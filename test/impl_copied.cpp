@@ -34,6 +34,8 @@ template<> struct boost::impl_ptr<Copied>::implementation
     mutable string trace_;
 };
 
+IMPL_PTR_INSTANTIATE(Copied, policy::copied);
+
 Copied::Copied ()      : impl_ptr_type(in_place) {}
 Copied::Copied (int k) : impl_ptr_type(in_place, k) {}
 
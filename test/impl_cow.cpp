@@ -0,0 +1,13 @@
+#include "./test.hpp"
+
+template<> struct boost::impl_ptr<Document>::implementation
+{
+    implementation (string const& s) : text_(s) {}
+
+    string text_;
+};
+
+Document::Document (string const& s) : impl_ptr_type(in_place, s) {}
+
+string Document::text () const { return (*this)->text_; }
+void Document::append (string const& s) { (*this)->text_ += s; }
@@ -0,0 +1,17 @@
+#include "./test.hpp"
+
+template<> struct boost::impl_ptr<Title>::implementation
+{
+    implementation (boost::string_view t) : text_(t.data(), t.size()) {}
+
+    string text_;
+};
+
+Title::Title (boost::string_view key) : impl_ptr_type(nullptr)
+{
+    *this = boost::impl_ptr_interned<Title>::get(key, key);
+}
+
+string  Title::text () const { return (*this)->text_; }
+Title   Title::find (boost::string_view key) { return boost::impl_ptr_interned<Title>::find(key); }
+size_t  Title::interned () { return boost::impl_ptr_interned<Title>::size(); }
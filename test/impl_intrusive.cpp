@@ -0,0 +1,31 @@
+#include "./test.hpp"
+
+template<> struct boost::impl_ptr<Node>::implementation
+{
+    implementation (int k) : int_(k) {}
+
+    int int_;
+};
+
+namespace
+{
+    std::atomic<int> live (0);
+
+    struct NamedNode : boost::impl_ptr<Node>::implementation // No virtual destructor.
+    {
+        NamedNode (int k, string const& n) : implementation(k), name_(n) { ++live; }
+       ~NamedNode () { --live; }
+
+        string name_;
+    };
+}
+
+Node::Node (int k) : impl_ptr_type(in_place, k) {}
+
+Node::Node (int k, string const& n) : impl_ptr_type(nullptr)
+{
+    emplace<NamedNode>(k, n);
+}
+
+int Node::value () const { return (*this)->int_; }
+int Node::derived_instances () { return live; }
@@ -0,0 +1,23 @@
+#include "./test.hpp"
+#include <chrono>
+#include <thread>
+
+namespace { std::atomic<int> count (0); }
+
+template<> struct boost::impl_ptr<Deferred>::implementation
+{
+    implementation (int k, string const& s) : int_(k + int(s.size()))
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1)); // Costly. Widens the race.
+        ++count;
+    }
+    implementation (Deferred const* other) : int_(other->value() + 1) { ++count; }
+
+    int int_;
+};
+
+Deferred::Deferred (int k, string const& s) : impl_ptr_type(in_place, k, s) {}
+Deferred::Deferred (Deferred const* other) : impl_ptr_type(in_place, other) {}
+
+int  Deferred::value () const { return (*this)->int_; }
+int  Deferred::constructed () { return count; }
@@ -0,0 +1,12 @@
+#include "./test.hpp"
+
+template<> struct boost::impl_ptr<Local>::implementation
+{
+    implementation (int k) : int_(k) {}
+
+    int int_;
+};
+
+Local::Local (int k) : impl_ptr_type(in_place, k) {}
+
+int Local::value () const { return (*this)->int_; }
@@ -0,0 +1,24 @@
+#include "./test.hpp"
+
+template<> struct boost::impl_ptr<Pmr>::implementation
+{
+    implementation (int k) : int_(k) {}
+
+    int int_;
+};
+
+Pmr::Pmr (int k) : impl_ptr_type(in_place, k) {}
+Pmr::Pmr (policy::pmr::memory_resource* mr, int k) : impl_ptr_type(std::allocator_arg, mr, in_place, k) {}
+
+int Pmr::value () const { return (*this)->int_; }
+
+template<> struct boost::impl_ptr<PmrUnique>::implementation
+{
+    implementation (int k) : int_(k) {}
+
+    int int_;
+};
+
+PmrUnique::PmrUnique (policy::pmr::memory_resource* mr, int k) : impl_ptr_type(std::allocator_arg, mr, in_place, k) {}
+
+int PmrUnique::value () const { return (*this)->int_; }
@@ -0,0 +1,33 @@
+#include "./test.hpp"
+
+namespace { std::atomic<int> live (0); }
+
+template<> struct boost::impl_ptr<Point>::implementation
+{
+    implementation (int k) : int_(k) { ++live; }
+    implementation (implementation const& o) : int_(o.int_) { ++live; }
+   ~implementation () { --live; int_ = -1; }
+
+    implementation& operator=(implementation const&) =default;
+
+    int int_;
+};
+
+Point::Point (int k) : impl_ptr_type(in_place, k) {}
+
+int         Point::value () const { return (*this)->int_; }
+char const* Point::address () const { return reinterpret_cast<char const*>(&**this); }
+int         Point::instances () { return live; }
+
+void
+Point::append(boost::impl_vector<Point>& v, int from, int to)
+{
+    for (int k = from; k < to; ++k)
+        v.emplace_back(k);
+}
+
+void
+Point::repeat(boost::impl_vector<Point>& v, size_t k)
+{
+    v.push_back(v[k]);
+}
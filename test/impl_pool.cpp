@@ -0,0 +1,15 @@
+#include "./test.hpp"
+
+template<> struct boost::impl_ptr<Pooled>::implementation
+{
+    implementation (int k) : int_(k) {}
+
+    int int_;
+};
+
+Pooled::Pooled (int k) : impl_ptr_type(in_place, k) {}
+
+int Pooled::value () const { return (*this)->int_; }
+
+void   Pooled::reserve  (size_t num) { boost::impl_ptr_pool<Pooled>::reserve(num); }
+size_t Pooled::capacity () { return boost::impl_ptr_pool<Pooled>::capacity(); }
@@ -0,0 +1,21 @@
+#include "./test.hpp"
+
+template<> struct boost::impl_ptr<Regional>::implementation
+{
+    implementation (int k) : int_(k) {}
+
+    int int_;
+};
+
+template<> struct boost::impl_ptr<Scratch>::implementation
+{
+    implementation (int k) : int_(k) {}
+
+    int int_;
+};
+
+Regional::Regional (int k) : impl_ptr_type(in_place, k) {}
+Scratch ::Scratch  (int k) : impl_ptr_type(in_place, k) {}
+
+int Regional::value () const { return (*this)->int_; }
+int Scratch ::value () const { return (*this)->int_; }
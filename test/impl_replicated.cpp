@@ -0,0 +1,25 @@
+#include "./test.hpp"
+
+namespace { std::atomic<int> live (0); }
+
+template<> struct boost::impl_ptr<Settings>::implementation
+{
+    implementation (int k) : int_(k) { ++live; }
+    implementation (implementation const& o) : int_(o.int_) { ++live; }
+   ~implementation () { --live; }
+
+    int int_;
+};
+
+Settings::Settings (int k) : impl_ptr_type(in_place, k) {}
+
+Settings::Settings (test::singleton_type) : impl_ptr_type(nullptr)
+{
+    static Settings single (0);
+
+    *this = single;
+}
+
+int  Settings::instances () { return live; }
+int  Settings::value () const { return (*this)->int_; }
+void Settings::value (int k) { update([k](impl_type& impl){ impl.int_ = k; }); }
@@ -0,0 +1,52 @@
+#include "./test.hpp"
+
+template<> struct boost::impl_ptr<Small>::implementation
+{
+    implementation (int k) : int_(k) {}
+    virtual ~implementation () =default;
+
+    virtual int value () const { return int_; }
+
+    int int_;
+};
+
+struct LargeImpl : boost::impl_ptr<Small>::implementation
+{
+    LargeImpl (int k, int l) : implementation(k) { data_[sizeof(data_) - 1] = char(l); }
+
+    int value () const override { return int_ + data_[sizeof(data_) - 1]; }
+
+    char data_[256] = {};
+};
+
+struct ThrowingMoveImpl : boost::impl_ptr<Small>::implementation
+{
+    ThrowingMoveImpl (int k) : implementation(k) {}
+    ThrowingMoveImpl (ThrowingMoveImpl&& o) noexcept(false) : implementation(o) {}
+};
+
+struct ScaledImpl : boost::impl_ptr<Small>::implementation
+{
+    ScaledImpl (int k) : implementation(k) {}
+
+    int value () const override { return int_ * 100; }
+};
+
+Small::Small (int k) : impl_ptr_type(in_place, k) {}
+
+Small::Small (long k) : impl_ptr_type(nullptr)
+{
+    emplace<ScaledImpl>(int(k));
+}
+
+Small::Small (double k) : impl_ptr_type(nullptr)
+{
+    emplace<ThrowingMoveImpl>(int(k));
+}
+
+Small::Small (int k, int l) : impl_ptr_type(nullptr)
+{
+    emplace<LargeImpl>(k, l);
+}
+
+int Small::value () const { return (*this)->value(); }
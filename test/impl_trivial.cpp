@@ -0,0 +1,34 @@
+#include "./test.hpp"
+
+template<> struct boost::impl_ptr<Trivial>::implementation
+{
+    int k, l;
+};
+
+template<> struct boost::impl_ptr<Packed>::implementation
+{
+    int k, l;
+};
+
+template<> struct boost::impl_ptr<Compact>::implementation
+{
+    implementation (int k, int l) : k(k), l(l) {}
+   ~implementation () { k = l = -1; } // Not trivial.
+
+    int k, l;
+};
+
+Trivial::Trivial (int k, int l) : impl_ptr_type(in_place, impl_type{ k, l }) {}
+Packed ::Packed  (int k, int l) : impl_ptr_type(in_place, impl_type{ k, l }) {}
+template<> struct boost::impl_ptr<CompactTrivial>::implementation
+{
+    int k, l;
+};
+
+Compact::Compact (int k, int l) : impl_ptr_type(in_place, k, l) {}
+CompactTrivial::CompactTrivial (int k, int l) : impl_ptr_type(in_place, impl_type{ k, l }) {}
+
+int Trivial::sum () const { return (*this)->k + (*this)->l; }
+int Packed ::sum () const { return (*this)->k + (*this)->l; }
+int Compact::sum () const { return (*this)->k + (*this)->l; }
+int CompactTrivial::sum () const { return (*this)->k + (*this)->l; }
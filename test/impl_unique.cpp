@@ -17,6 +17,8 @@ template<> struct boost::impl_ptr<Unique>::implementation
     mutable string trace_;
 };
 
+IMPL_PTR_INSTANTIATE(Unique, policy::unique);
+
 Unique::Unique ()      : impl_ptr_type(in_place) {}
 Unique::Unique (int k) : impl_ptr_type(in_place, k) {}
 
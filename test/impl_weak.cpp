@@ -0,0 +1,24 @@
+#include "./test.hpp"
+
+namespace
+{
+    std::atomic<int>                 live (0);
+    boost::impl_ptr_cache<Cached, int> cache (2);
+}
+
+template<> struct boost::impl_ptr<Cached>::implementation
+{
+    implementation (int k) : int_(k) { ++live; }
+   ~implementation () { --live; }
+
+    int int_;
+};
+
+Cached::Cached (int k) : impl_ptr_type(nullptr)
+{
+    *this = cache.get(k, k);
+}
+
+int    Cached::value () const { return (*this)->int_; }
+int    Cached::instances () { return live; }
+size_t Cached::cached () { return cache.size(); }
@@ -1,4 +1,6 @@
 #include "./test.hpp"
+#include <set>
+#include <thread>
 
 static
 void
@@ -178,6 +180,577 @@ test_shared()
     BOOST_TEST(s32 == s33); // calls impl_ptr::op==()
 }
 
+static
+void
+test_local_shared()
+{
+    BOOST_TEST(sizeof(Local) == sizeof(void*));
+
+    Local l01 (1);
+    Local l02 (l01); // Shared.
+    Local l03 (3);
+
+    BOOST_TEST(&*l01 == &*l02);
+    BOOST_TEST(l01 == l02);
+    BOOST_TEST(l01 != l03);
+    BOOST_TEST(l01.use_count() == 2);
+    BOOST_TEST(l02.value() == 1);
+
+    l02 = l03;
+
+    BOOST_TEST(l01.use_count() == 1);
+    BOOST_TEST(l03.use_count() == 2);
+    BOOST_TEST(l02.value() == 3);
+
+    Local l04 (std::move(l03));
+
+    BOOST_TEST(!l03);
+    BOOST_TEST(l04.use_count() == 2);
+
+    l01.swap(l04);
+
+    BOOST_TEST(l01.value() == 3);
+    BOOST_TEST(l04.value() == 1);
+
+    l01 = boost::impl_ptr<Local>::null();
+
+    BOOST_TEST(l02.use_count() == 1);
+}
+
+static
+void
+test_biased()
+{
+    BOOST_TEST(sizeof(Session) == sizeof(void*));
+    {
+        Session s01 (1);
+        Session s02 (s01); // Owner thread. Not atomic.
+
+        BOOST_TEST(&*s01 == &*s02);
+        BOOST_TEST(s01 == s02);
+        BOOST_TEST(s01.use_count() == 2);
+        BOOST_TEST(Session::instances() == 1);
+
+        // Copied and released by other threads. Atomic.
+        std::vector<std::thread> threads;
+
+        for (int k = 0; k < 4; ++k)
+            threads.emplace_back([&s01]
+            {
+                for (int n = 0; n < 1000; ++n)
+                {
+                    Session copy (s01);
+                    BOOST_TEST(copy.value() == 1);
+                }
+            });
+        for (std::thread& thread : threads) thread.join();
+
+        BOOST_TEST(s01.use_count() == 2);
+        BOOST_TEST(Session::instances() == 1);
+    }
+    BOOST_TEST(Session::instances() == 0);
+    {
+        // Copied on the owner thread. Released on another one.
+        Session s11 (11);
+        Session s12 (s11);
+
+        std::thread([&]{ Session s (std::move(s12)); }).join();
+
+        BOOST_TEST(s11.use_count() == 1);
+        BOOST_TEST(Session::instances() == 1);
+    }
+    BOOST_TEST(Session::instances() == 0); // Merged by the owner.
+    {
+        // A producer: handed over, released by another thread, never released by the owner.
+        Session s21 (21);
+
+        std::thread([&]{ Session s (std::move(s21)); }).join();
+
+        BOOST_TEST(Session::instances() == 1); // Queued to the owner.
+
+        Session s22 (22); // Merged on the next construction.
+
+        BOOST_TEST(Session::instances() == 1);
+    }
+    BOOST_TEST(Session::instances() == 0);
+
+    // The owner thread exits first.
+    std::vector<Session> sessions;
+
+    std::thread([&]{ Session s (21); for (int k = 0; k < 3; ++k) sessions.push_back(s); }).join();
+
+    BOOST_TEST(sessions[0].value() == 21);
+    BOOST_TEST(sessions[0].use_count() == 3);
+    BOOST_TEST(Session::instances() == 1);
+
+    sessions.clear();
+
+    BOOST_TEST(Session::instances() == 0);
+}
+
+static
+void
+test_intrusive()
+{
+    BOOST_TEST(sizeof(Node) == sizeof(void*));
+    BOOST_TEST(sizeof(Node) * 2 == sizeof(Shared));
+
+    Node n01 (1);
+    Node n02 (n01);
+    Node n03 (3);
+
+    BOOST_TEST(&*n01 == &*n02);
+    BOOST_TEST(n01 == n02);
+    BOOST_TEST(n01 != n03);
+    BOOST_TEST(n01.use_count() == 2);
+
+    n02 = n03;
+
+    BOOST_TEST(n01.use_count() == 1);
+    BOOST_TEST(n02.value() == 3);
+    {
+        Node n11 (11, "derived");
+        Node n12 (n11);
+
+        BOOST_TEST(n12.value() == 11);
+        BOOST_TEST(Node::derived_instances() == 1);
+    }
+    BOOST_TEST(Node::derived_instances() == 0); // Destroyed as derived (no virtual destructor).
+
+    // Copied and destroyed concurrently.
+    std::vector<std::thread> threads;
+
+    for (int k = 0; k < 4; ++k)
+        threads.emplace_back([&n01]{ for (int n = 0; n < 1000; ++n) { Node copy (n01); BOOST_TEST(copy.value() == 1); } });
+
+    for (std::thread& thread : threads) thread.join();
+
+    BOOST_TEST(n01.use_count() == 1);
+}
+
+static
+void
+test_interned()
+{
+    std::string const key = "title";
+
+    BOOST_TEST(!Title::find(key));
+
+    Title t01 (key);
+    Title t02 (boost::string_view("title")); // Same implementation.
+    Title t03 ("other");
+
+    BOOST_TEST(&*t01 == &*t02);
+    BOOST_TEST(&*t01 != &*t03);
+    BOOST_TEST(t01.text() == "title");
+    BOOST_TEST(t03.text() == "other");
+    BOOST_TEST(Title::find("title") == t01);
+    BOOST_TEST(Title::interned() == 2);
+
+    // Concurrent construction of the same keys.
+    std::vector<std::thread> threads;
+    std::vector<Title>        titles (4 * 100, boost::impl_ptr<Title>::null());
+
+    for (int k = 0; k < 4; ++k)
+        threads.emplace_back([k, &titles]
+        {
+            for (int n = 0; n < 100; ++n)
+                titles[k * 100 + n] = Title(std::to_string(n));
+        });
+    for (std::thread& thread : threads) thread.join();
+
+    for (int n = 0; n < 100; ++n)
+        for (int k = 1; k < 4; ++k)
+            BOOST_TEST(titles[k * 100 + n] == titles[n]);
+
+    BOOST_TEST(Title::interned() == 102);
+}
+
+static
+void
+test_weak()
+{
+    Shared                     s01 (1);
+    boost::weak_impl_ptr<Shared> w01 (s01);
+
+    BOOST_TEST(!w01.expired());
+    BOOST_TEST(w01.lock() == s01);
+    BOOST_TEST(s01.use_count() == 1); // Not owned by the weak reference.
+
+    s01 = boost::impl_ptr<Shared>::null();
+
+    BOOST_TEST(w01.expired());
+    BOOST_TEST(!w01.lock());
+
+    // Cache with the capacity of 2.
+    Cached c01 (1);
+    Cached c02 (2);
+    Cached c03 (3); // #1 evicted but still referenced.
+
+    BOOST_TEST(Cached::instances() == 3);
+    BOOST_TEST(Cached(1) == c01);
+
+    c01 = c02 = c03 = boost::impl_ptr<Cached>::null(); // #1 (the most recently used) and #3 kept alive.
+
+    BOOST_TEST(Cached::instances() == 2);
+
+    Cached c04 (2); // Released. Constructed again. #3 evicted and released.
+
+    BOOST_TEST(c04.value() == 2);
+    BOOST_TEST(Cached::instances() == 2);
+
+    for (int k = 10; k < 100; ++k) Cached(k).value(); // Only the two most recent kept. The released entries purged.
+
+    BOOST_TEST(Cached::instances() == 3); // #98, #99 and #2 (referenced).
+    BOOST_TEST(Cached::cached() < 64);
+}
+
+static
+void
+test_lazy()
+{
+    int const before = Deferred::constructed();
+
+    Deferred d01 (1, "one");
+
+    BOOST_TEST(d01);                 // Not null. Not constructed by the check.
+    BOOST_TEST(Deferred::constructed() == before);
+
+    BOOST_TEST(d01.value() == 4);    // 1 + strlen("one"). Constructed.
+    BOOST_TEST(Deferred::constructed() == before + 1);
+    BOOST_TEST(d01.value() == 4);    // Not constructed again.
+    BOOST_TEST(Deferred::constructed() == before + 1);
+
+    Deferred d02 (2, "two");
+    Deferred d03 (std::move(d02));   // Moved before the construction.
+
+    BOOST_TEST(!d02);
+    BOOST_TEST(d03.value() == 5);
+
+    Deferred d04 (boost::impl_ptr<Deferred>::null());
+
+    BOOST_TEST(!d04);
+
+    // First accessed by several threads at once. Constructed once.
+    Deferred                 d05 (5, "five");
+    std::vector<std::thread> threads;
+
+    for (int k = 0; k < 8; ++k)
+        threads.emplace_back([&d05]{ BOOST_TEST(d05.value() == 9); });
+
+    for (std::thread& thread : threads) thread.join();
+
+    BOOST_TEST(Deferred::constructed() == before + 3);
+
+    // Constructed on the first access of another one. Apart by any distance.
+    struct { Deferred first; char gap[512 - sizeof(Deferred)]; Deferred second; } d06 { Deferred(&d06.second), {}, Deferred(6, "six") };
+
+    BOOST_TEST(d06.first.value() == 10);
+    BOOST_TEST(Deferred::constructed() == before + 5);
+}
+
+static
+void
+test_vector()
+{
+    int const before = Point::instances();
+    {
+        boost::impl_vector<Point> v01;
+
+        v01.reserve(10); // Recorded. The implementation size is not known here.
+
+        Point::append(v01, 0, 100); // Relocated on growth.
+
+        BOOST_TEST(v01.size() == 100);
+        BOOST_TEST(Point::instances() == before + 100);
+
+        // Contiguous and in order.
+        std::ptrdiff_t const stride = v01[1].address() - v01[0].address();
+
+        for (size_t k = 0; k < v01.size(); ++k)
+        {
+            BOOST_TEST(v01[k].value() == int(k));
+            BOOST_TEST(v01[k].address() == v01[0].address() + k * stride);
+        }
+
+        Point p01 = v01[5]; // An independent copy.
+
+        BOOST_TEST(p01.value() == 5);
+        BOOST_TEST(p01.address() != v01[5].address());
+
+        auto it = v01.erase(v01.begin() + 5); // The rest relocated.
+
+        BOOST_TEST(it->value() == 6);
+        BOOST_TEST(v01.size() == 99);
+        BOOST_TEST(v01[5].address() == v01[0].address() + 5 * stride);
+        BOOST_TEST(Point::instances() == before + 100); // 99 and p01.
+
+        v01.pop_back();
+        Point::append(v01, 5, 6);
+
+        BOOST_TEST(v01.back().value() == 5);
+
+        int sum = 0;
+
+        for (Point const& p : v01) sum += p.value();
+
+        BOOST_TEST(sum == 4950 - 5 - 99 + 5);
+
+        boost::impl_vector<Point> v02 (std::move(v01));
+
+        BOOST_TEST(v01.empty() && v02.size() == 99);
+
+        v02.clear();
+
+        BOOST_TEST(Point::instances() == before + 1);
+
+        Point::append(v02, 7, 7 + int(v02.capacity())); // Full.
+        Point::repeat(v02, 0);                          // An element of its own: relocated on growth.
+
+        BOOST_TEST(v02.back().value() == 7);
+        BOOST_TEST(v02[0].value() == 7);
+    }
+    BOOST_TEST(Point::instances() == before);
+}
+
+static
+void
+test_soa()
+{
+    std::vector<Body> b01;
+
+    for (int k = 0; k < 100; ++k)
+        b01.emplace_back(k, 2 * k, "body " + std::to_string(k)); // Longer than the small-string buffer.
+
+    std::vector<Body> b02 = Body::advance(b01, 0.5);
+
+    BOOST_TEST(b02.size() == 100);
+    BOOST_TEST(Body::aligned(b01));
+
+    for (size_t k = 0; k < b02.size(); ++k)
+    {
+        BOOST_TEST(b02[k].x() == 2. * k);
+        BOOST_TEST(b02[k].v() == 2. * k);
+        BOOST_TEST(b02[k].name() == b01[k].name());
+        BOOST_TEST(b01[k].x() == double(k)); // Gathered into independent Pimpls.
+    }
+
+    std::vector<Body> b03 = Body::reverse(b01);
+
+    BOOST_TEST(b03.size() == 100);
+
+    for (size_t k = 0; k < b03.size(); ++k)
+    {
+        BOOST_TEST(b03[k].x() == b01[99 - k].x());
+        BOOST_TEST(b03[k].name() == b01[99 - k].name());
+    }
+}
+
+static
+void
+test_batch()
+{
+    int const before = Batched::instances();
+    {
+        std::vector<Batched> b01 = Batched::make(100, 7);
+
+        BOOST_TEST(b01.size() == 100);
+        BOOST_TEST(Batched::instances() == before + 100);
+
+        // One block: evenly spaced.
+        std::ptrdiff_t const stride = b01[1].address() - b01[0].address();
+
+        for (size_t k = 0; k < b01.size(); ++k)
+        {
+            BOOST_TEST(b01[k].value() == 7);
+            BOOST_TEST(b01[k].address() == b01[0].address() + k * stride);
+        }
+
+        b01[5].value(5);
+
+        std::vector<Batched> b02 = Batched::copy(b01);
+
+        BOOST_TEST(b02.size() == 100);
+        BOOST_TEST(b02[5].value() == 5);
+        BOOST_TEST(b02[6].value() == 7);
+        BOOST_TEST(b02[0].address() != b01[0].address());
+        BOOST_TEST(b02[1].address() - b02[0].address() == stride);
+
+        Batched c01 = b01[9]; // Outside make_n()/clone(): from the heap.
+
+        BOOST_TEST(c01.value() == 7);
+
+        b01.erase(b01.begin() + 10, b01.end()); // The block kept by the rest.
+
+        BOOST_TEST(b01[9].value() == 7);
+        BOOST_TEST(Batched::instances() == before + 111);
+
+        std::thread([&b01]{ b01.clear(); }).join(); // The last ones released on another thread.
+
+        BOOST_TEST(Batched::instances() == before + 101);
+    }
+    {
+        // A derived implementation (from the heap) released through the traits of the base.
+        Batched d01 (3, 1.5L);
+
+        BOOST_TEST(d01.value() == 3);
+        BOOST_TEST(reinterpret_cast<uintptr_t>(d01.address()) % alignof(long double) == 0);
+
+        Batched        d02 = d01;
+        std::vector<Batched> b01 = Batched::copy({ d01, Batched(4) });
+
+        BOOST_TEST(d02.value() == 3);
+        BOOST_TEST(b01[0].value() == 3);
+        BOOST_TEST(Batched::instances() == before + 4);
+    }
+    BOOST_TEST(Batched::instances() == before);
+}
+
+static
+void
+test_replicated()
+{
+    Settings s01 (test::singleton);
+    Settings s02 (test::singleton);
+    Settings s03 (3);
+
+    BOOST_TEST(s01 == s02);
+    BOOST_TEST(s01 != s03);
+    BOOST_TEST(s01.use_count() == 3); // s01, s02 and the singleton itself.
+    BOOST_TEST(s03.value() == 3);
+
+    s01.value(1);
+
+    BOOST_TEST(s02.value() == 1);
+
+    // Copied, read and released on other threads (and counted in their slots).
+    std::vector<std::thread> threads;
+
+    for (int k = 0; k < 8; ++k)
+        threads.emplace_back([&s01]
+        {
+            for (int n = 0; n < 1000; ++n)
+            {
+                Settings copy (s01);
+                BOOST_TEST(copy.value() == 1);
+            }
+        });
+    for (std::thread& thread : threads) thread.join();
+
+    BOOST_TEST(s01.use_count() == 3);
+
+    // Updated while read on other threads. Every thread reads its own replica: in update order.
+    // Readers' pointers are only valid across 'retained' - 1 updates: that many while read.
+    std::atomic<bool> done { false };
+    std::atomic<int>  errors { 0 };
+
+    threads.clear();
+
+    for (int k = 0; k < 4; ++k)
+        threads.emplace_back([&]
+        {
+            for (int last = 0, value; !done.load(); last = value)
+                if ((value = s02.value()) < last)
+                    ++errors;
+        });
+    int const updates = int(policy::replicated<void>::retained) - 1;
+
+    for (int k = 1; k <= updates; ++k) s01.value(k);
+
+    done = true;
+
+    for (std::thread& thread : threads) thread.join();
+
+    BOOST_TEST(errors == 0);
+    BOOST_TEST(s02.value() == updates);
+
+    // Only the last superseded generations are kept.
+    int const steady = Settings::instances();
+
+    for (int k = 1; k <= 100; ++k) s01.value(k);
+
+    BOOST_TEST(Settings::instances() == steady);
+    BOOST_TEST(s02.value() == 100);
+
+    Settings s04 = std::move(s03);
+
+    BOOST_TEST(!s03);
+    BOOST_TEST(s04.value() == 3);
+    BOOST_TEST(s04.use_count() == 1);
+}
+
+static
+void
+test_atomic()
+{
+    int const before = Routes::instances();
+    {
+        Routes                        r01 (1);
+        boost::impl_ptr_atomic<Routes> a01 (r01);
+
+        BOOST_TEST(a01.snapshot()->value() == 1);
+        BOOST_TEST(a01.load() == r01);
+        BOOST_TEST(r01.use_count() == 2); // r01 and the stored copy. A snapshot is not counted.
+
+        a01.store(Routes(2)); // No readers. The old copy released right away.
+
+        BOOST_TEST(r01.use_count() == 1);
+        BOOST_TEST(a01.snapshot()->value() == 2);
+
+        Routes r02 = a01.exchange(r01);
+
+        BOOST_TEST(r02.value() == 2);
+        BOOST_TEST(a01.load() == r01);
+
+        Routes expected = r02; // Not current.
+
+        BOOST_TEST(!a01.compare_exchange(expected, Routes(3)));
+        BOOST_TEST(expected == r01);
+        BOOST_TEST(a01.compare_exchange(expected, Routes(4)));
+        BOOST_TEST(a01.snapshot()->value() == 4);
+
+        {
+            auto s01 = a01.snapshot(); // Keeps #4 (held by a01 only) alive.
+            auto s02 = a01.snapshot(); // Nested.
+
+            a01.store(r02);
+
+            BOOST_TEST(s01->value() == 4);
+            BOOST_TEST(s02->value() == 4);
+            BOOST_TEST(Routes::instances() == before + 3); // #1, #2 and #4 (retired).
+        }
+        a01.store(r01); // #4 released.
+
+        BOOST_TEST(Routes::instances() == before + 2);
+
+        // Readers while a writer swaps.
+        std::atomic<bool>        done (false);
+        std::vector<std::thread> readers;
+
+        for (int k = 0; k < 4; ++k)
+            readers.emplace_back([&]
+            {
+                while (!done.load())
+                {
+                    int const value = a01.snapshot()->value();
+
+                    BOOST_TEST(0 < value && value <= 1000);
+                }
+            });
+        for (int k = 1; k <= 1000; ++k)
+            a01.store(Routes(k));
+
+        done = true;
+
+        for (std::thread& thread : readers) thread.join();
+
+        a01.store(r01); // All retired released.
+
+        BOOST_TEST(Routes::instances() == before + 2); // #1 and #2.
+    }
+    BOOST_TEST(Routes::instances() == before);
+}
+
 static
 void
 test_copied()
@@ -237,6 +810,52 @@ test_inplace()
 
     s11 = s12;          BOOST_TEST(s11.value() == 5);
     s11 = InPlace(6);   BOOST_TEST(s11.value() == 6);
+
+    s11.swap(s13);      BOOST_TEST(!s11); BOOST_TEST(s13.value() == 6);
+    s12.swap(s13);      BOOST_TEST(s12.value() == 6); BOOST_TEST(s13.value() == 5);
+}
+
+static
+void
+test_trivial()
+{
+    Trivial t11 (1, 2); BOOST_TEST(t11.sum() == 3);
+    Trivial t12 (t11);  BOOST_TEST(t12.sum() == 3);
+    Trivial t13 = boost::impl_ptr<Trivial>::null();
+    Packed  p11 (3, 4); BOOST_TEST(p11.sum() == 7);
+    Packed  p12 (5, 6);
+
+    BOOST_TEST((void*) &t12 == (void*) &*t12);
+
+    t12 = Trivial(3, 4); BOOST_TEST(t12.sum() == 7);
+    t13 = t12;           BOOST_TEST(t13.sum() == 7);
+    t12 = boost::impl_ptr<Trivial>::null();
+
+    BOOST_TEST(!t12);
+
+    t11.swap(t12); BOOST_TEST(!t11); BOOST_TEST(t12.sum() == 3);
+    p11.swap(p12); BOOST_TEST(p11.sum() == 11); BOOST_TEST(p12.sum() == 7); // Detected at run time.
+    p11 = p12;     BOOST_TEST(p11.sum() == 7);
+
+    Compact c11 (1, 2); BOOST_TEST(c11.sum() == 3);
+    Compact c12 = boost::impl_ptr<Compact>::null();
+    Compact c13 (c11);  BOOST_TEST(c13.sum() == 3);
+
+    BOOST_TEST(!c12);
+    BOOST_TEST(bool(c13));
+
+    c12 = c13;                                 BOOST_TEST(c12.sum() == 3);
+    c13 = boost::impl_ptr<Compact>::null();    BOOST_TEST(!c13);
+    c11.swap(c13);                             BOOST_TEST(!c11); BOOST_TEST(c13.sum() == 3);
+    c11 = Compact(4, 5);                       BOOST_TEST(c11.sum() == 9);
+
+    CompactTrivial c21 (1, 2);
+    CompactTrivial c22 = boost::impl_ptr<CompactTrivial>::null();
+
+    c21.swap(c22); BOOST_TEST(!c21); BOOST_TEST(c22.sum() == 3);
+    c21.swap(c22); BOOST_TEST(c21.sum() == 3); BOOST_TEST(!c22);
+    c22 = c21;     BOOST_TEST(c22.sum() == 3);
+    c21 = boost::impl_ptr<CompactTrivial>::null(); BOOST_TEST(!c21);
 }
 
 static
@@ -256,6 +875,456 @@ test_always_inplace()
     s11 = AlwaysInPlace(6);   BOOST_TEST(s11.value() == 6);
 }
 
+static
+void
+test_relocation()
+{
+    static_assert( std::is_nothrow_move_constructible<Copied>::value, "");
+    static_assert( std::is_nothrow_move_assignable   <Copied>::value, "");
+    static_assert( std::is_nothrow_move_constructible<Unique>::value, "");
+    static_assert( std::is_nothrow_move_assignable   <Unique>::value, "");
+    static_assert( std::is_nothrow_move_constructible<Shared>::value, "");
+    static_assert( std::is_nothrow_move_assignable   <Shared>::value, "");
+    static_assert( std::is_nothrow_move_constructible<Trivial>::value, "");
+    static_assert(!std::is_nothrow_move_constructible<InPlace>::value, "Implementation moves may throw");
+    static_assert(!std::is_nothrow_move_assignable   <Pmr>::value, "Unequal resources: the value is moved");
+
+    static_assert( boost::is_trivially_relocatable<Copied>::value, "");
+    static_assert( boost::is_trivially_relocatable<Unique>::value, "");
+    static_assert( boost::is_trivially_relocatable<Shared>::value, "");
+    static_assert( boost::is_trivially_relocatable<Pooled>::value, "");
+    static_assert( boost::is_trivially_relocatable<Trivial>::value, "");
+    static_assert( boost::is_trivially_relocatable<int>::value, "");
+    static_assert(!boost::is_trivially_relocatable<InPlace>::value, "");
+    static_assert(!boost::is_trivially_relocatable<Small>::value, "Points into itself");
+    static_assert(!boost::is_trivially_relocatable<Pmr>::value, "");
+    static_assert(!boost::is_trivially_relocatable<Book>::value, "Not opted in");
+
+    using copied_storage = typename std::aligned_storage<sizeof(Copied), alignof(Copied)>::type;
+    using inplace_storage = typename std::aligned_storage<sizeof(InPlace), alignof(InPlace)>::type;
+
+    copied_storage  cs1[3], cs2[3];
+    inplace_storage is1[2], is2[2];
+
+    Copied*  c = reinterpret_cast<Copied*>(cs1);
+    InPlace* i = reinterpret_cast<InPlace*>(is1);
+
+    for (int k = 0; k < 3; ++k) new (c + k) Copied(k);
+    for (int k = 0; k < 2; ++k) new (i + k) InPlace(k);
+
+    Copied*  c_end = boost::uninitialized_relocate(c, c + 3, reinterpret_cast<Copied*>(cs2)); // memcpy
+    InPlace* i_end = boost::uninitialized_relocate(i, i + 2, reinterpret_cast<InPlace*>(is2)); // move + destroy
+
+    c = reinterpret_cast<Copied*>(cs2);
+    i = reinterpret_cast<InPlace*>(is2);
+
+    BOOST_TEST(c_end == c + 3);
+    BOOST_TEST(i_end == i + 2);
+    BOOST_TEST(c[2].value() == 2);
+    BOOST_TEST(i[1].value() == 1);
+
+    Copied* c1 = boost::relocate_at(c + 1, reinterpret_cast<Copied*>(cs1));
+
+    BOOST_TEST(c1->value() == 1);
+
+    c1->~Copied();
+    c[0].~Copied();
+    c[2].~Copied();
+    i[0].~InPlace();
+    i[1].~InPlace();
+}
+
+static
+void
+test_small()
+{
+    auto in_place = [](Small const& s) { return (void const*) &s == (void const*) &*s; };
+
+    Small s01 (1);    BOOST_TEST(s01.value() ==  1); BOOST_TEST( in_place(s01));
+    Small s02 (2, 8); BOOST_TEST(s02.value() == 10); BOOST_TEST(!in_place(s02)); // Too large. On the heap.
+    Small s03 (s01);  BOOST_TEST(s03.value() ==  1); BOOST_TEST( in_place(s03));
+    Small s04 (s02);  BOOST_TEST(s04.value() ==  2); BOOST_TEST(!in_place(s04)); // Copied as the base (as 'copied').
+
+    void const* heap = &*s02;
+    Small       s05 (std::move(s02)); // The heap implementation is handed over.
+
+    BOOST_TEST(&*s05 == heap);
+    BOOST_TEST(!s02);
+
+    Small s06 (std::move(s01)); // Moved in place. The source becomes null.
+
+    BOOST_TEST(s06.value() == 1);
+    BOOST_TEST(in_place(s06));
+    BOOST_TEST(!s01);
+
+    // All four in-place/heap combinations.
+    Small s11 (11), s12 (12), s13 (13, 0), s14 (14, 0);
+
+    s11.swap(s12); BOOST_TEST(s11.value() == 12); BOOST_TEST(s12.value() == 11); BOOST_TEST(in_place(s11) && in_place(s12));
+    s13.swap(s14); BOOST_TEST(s13.value() == 14); BOOST_TEST(s14.value() == 13); BOOST_TEST(!in_place(s13) && !in_place(s14));
+    s11.swap(s13); BOOST_TEST(s11.value() == 14); BOOST_TEST(s13.value() == 12); BOOST_TEST(!in_place(s11) && in_place(s13));
+    s11.swap(s13); BOOST_TEST(s11.value() == 12); BOOST_TEST(s13.value() == 14); BOOST_TEST(in_place(s11) && !in_place(s13));
+
+    s12 = s13;            BOOST_TEST(s12.value() == 14); BOOST_TEST( in_place(s12)); // Assigned in place.
+    s13 = Small(15);      BOOST_TEST(s13.value() == 15); BOOST_TEST( in_place(s13));
+    s11 = Small(16, 1);   BOOST_TEST(s11.value() == 17); BOOST_TEST(!in_place(s11));
+    s11 = s01;            BOOST_TEST(!s11);
+
+    static_assert(std::is_nothrow_move_constructible<Small>::value, "");
+    static_assert(std::is_nothrow_move_assignable<Small>::value, "");
+
+    Small s21 (21.); BOOST_TEST(s21.value() == 21); BOOST_TEST(!in_place(s21)); // Throwing on move. On the heap.
+
+    std::vector<Small> v01;
+
+    v01.emplace_back(31, 0);
+    v01.emplace_back(32);
+
+    void const* heap31 = &*v01[0];
+
+    v01.reserve(v01.capacity() + 1); // Moved (not copied) on reallocation.
+
+    BOOST_TEST(&*v01[0] == heap31);
+    BOOST_TEST(v01[1].value() == 32 && in_place(v01[1]));
+
+    // A derived implementation in place: copied, moved and swapped as such.
+    Small s31 (2L);       BOOST_TEST(s31.value() == 200); BOOST_TEST(in_place(s31));
+    Small s32 (s31);      BOOST_TEST(s32.value() == 200); BOOST_TEST(in_place(s32));
+    Small s33 (std::move(s31)); BOOST_TEST(s33.value() == 200); BOOST_TEST(in_place(s33));
+    Small s34 (4);
+
+    s34.swap(s33); BOOST_TEST(s34.value() == 200); BOOST_TEST(s33.value() == 4);
+    s33 = s34;     BOOST_TEST(s33.value() == 200); // Not assigned into the base.
+    s34 = Small(5); BOOST_TEST(s34.value() == 5);
+
+    std::vector<Small> v02;
+
+    for (long k = 1; k <= 5; ++k) v02.emplace_back(k); // Reallocated.
+    for (long k = 1; k <= 5; ++k) BOOST_TEST(v02[k - 1].value() == k * 100);
+}
+
+static
+void
+test_cow()
+{
+    auto address = [](Document const& d) { return (void const*) &*d; }; // Const access. Does not detach.
+
+    Document d01 ("abc");
+    Document d02 (d01); // Shared.
+
+    BOOST_TEST(address(d01) == address(d02));
+    BOOST_TEST(d01.use_count() == 2);
+    BOOST_TEST(d02.text() == "abc");
+
+    d02.append("def"); // Detached on the first non-const access.
+
+    BOOST_TEST(address(d01) != address(d02));
+    BOOST_TEST(d01.use_count() == 1);
+    BOOST_TEST(d02.use_count() == 1);
+    BOOST_TEST(d01.text() == "abc");
+    BOOST_TEST(d02.text() == "abcdef");
+
+    void const* unique = address(d02);
+
+    d02.append("ghi"); // Not shared. Modified in place.
+
+    BOOST_TEST(address(d02) == unique);
+    BOOST_TEST(d02.text() == "abcdefghi");
+
+    Document d03 (d01);
+
+    d03.detach(); // Explicit.
+
+    BOOST_TEST(address(d01) != address(d03));
+    BOOST_TEST(d03.text() == "abc");
+
+    Document d04 (std::move(d03));
+
+    BOOST_TEST(!d03);
+    BOOST_TEST(d04.use_count() == 1);
+
+    // Copies of one implementation modified on different threads.
+    std::vector<std::thread> threads;
+
+    for (int k = 0; k < 4; ++k)
+        threads.emplace_back([&d01]
+        {
+            for (int n = 0; n < 1000; ++n)
+            {
+                Document copy (d01);
+
+                copy.append("x");
+                BOOST_TEST(copy.text() == "abcx");
+            }
+        });
+    for (std::thread& thread : threads) thread.join();
+
+    BOOST_TEST(d01.use_count() == 1);
+    BOOST_TEST(d01.text() == "abc");
+}
+
+static
+void
+test_allocators()
+{
+    // Stateless allocators take no space.
+    BOOST_TEST(sizeof(Unique) == sizeof(void*));
+    BOOST_TEST(sizeof(Copied) == sizeof(void*));
+    BOOST_TEST(sizeof(Shared) == sizeof(std::shared_ptr<int>));
+
+    arena arena1;
+    arena arena2;
+    {
+        Allocated a11 (arena1, 1); BOOST_TEST(arena1.allocated == 1);
+        Allocated a12 (a11);       BOOST_TEST(arena1.allocated == 2); // Copy allocated from the same arena.
+        Allocated a21 (arena2, 2); BOOST_TEST(arena2.allocated == 1);
+
+        a21 = a11; // Propagating allocator: the old implementation is released to its own arena.
+
+        BOOST_TEST(a21.value() == 1);
+        BOOST_TEST(arena1.allocated == 3);
+        BOOST_TEST(arena2.allocated == 0);
+
+        Allocated a13 (std::move(a12)); BOOST_TEST(arena1.allocated == 3); // Moved, not allocated.
+        Allocated a22 (arena2, 5);
+
+        a13.swap(a22);
+
+        BOOST_TEST(a13.value() == 5);
+        BOOST_TEST(a22.value() == 1);
+    }
+    BOOST_TEST(arena1.allocated == 0);
+    BOOST_TEST(arena2.allocated == 0);
+}
+
+// Checks every block is returned to the resource it came from.
+struct tracking_resource : policy::pmr::memory_resource
+{
+   ~tracking_resource () { BOOST_TEST(live.empty()); }
+
+    std::set<void*> live;
+
+    private:
+
+    void*
+    do_allocate(size_t size, size_t) override
+    {
+        void* p = ::operator new(size);
+
+        live.insert(p);
+        return p;
+    }
+    void
+    do_deallocate(void* p, size_t, size_t) override
+    {
+        BOOST_TEST(live.erase(p) == 1);
+        ::operator delete(p);
+    }
+    bool do_is_equal (memory_resource const& o) const noexcept override { return this == &o; }
+};
+
+static
+void
+test_pmr()
+{
+    char                              buffer[256];
+    policy::pmr::monotonic_buffer_resource mr (buffer, sizeof(buffer), policy::pmr::null_memory_resource());
+
+    auto in_buffer = [&](Pmr const& p)
+    {
+        return (void*) buffer <= (void*) &*p && (void*) &*p < (void*) (buffer + sizeof(buffer));
+    };
+
+    Pmr p11 (&mr, 1); BOOST_TEST(p11.value() == 1); BOOST_TEST( in_buffer(p11));
+    Pmr p12 (2);      BOOST_TEST(p12.value() == 2); BOOST_TEST(!in_buffer(p12)); // Default resource.
+    Pmr p13 (p11);    BOOST_TEST(p13.value() == 1); BOOST_TEST(!in_buffer(p13)); // Copies use the default resource.
+
+    p11 = p12; // The resource does not propagate. The value is assigned in place.
+
+    BOOST_TEST(p11.value() == 2);
+    BOOST_TEST(in_buffer(p11));
+
+    p11 = std::move(p13); // Unequal resources. The value is moved into the buffer.
+
+    BOOST_TEST(p11.value() == 1);
+    BOOST_TEST(in_buffer(p11));
+
+    tracking_resource r1, r2;
+    {
+        Pmr c01 (&r1, 1);
+        Pmr c02 (&r2, 2);
+
+        c01.swap(c02); // Unequal resources. The values are swapped.
+
+        BOOST_TEST(c01.value() == 2 && r1.live.count(&*c01));
+        BOOST_TEST(c02.value() == 1 && r2.live.count(&*c02));
+    }
+    {
+        PmrUnique u01 (&r1, 1);
+        PmrUnique u02 (&r2, 2);
+
+        u01 = std::move(u02); // Unequal resources. The value is moved into r1.
+
+        BOOST_TEST(u01.value() == 2);
+        BOOST_TEST(r1.live.size() == 1 && r1.live.count(&*u01));
+
+        PmrUnique u03 (&r1, 3);
+        PmrUnique u04 (&r2, 4);
+
+        u03.swap(u04); // Unequal resources. The values are swapped.
+
+        BOOST_TEST(u03.value() == 4 && r1.live.count(&*u03));
+        BOOST_TEST(u04.value() == 3 && r2.live.count(&*u04));
+
+        PmrUnique u05 (&r1, 5);
+
+        u05 = std::move(u01); // Equal resources. The implementation changes hands.
+
+        BOOST_TEST(u05.value() == 2);
+    }
+    BOOST_TEST(r1.live.empty() && r2.live.empty());
+}
+
+static
+void
+test_region()
+{
+    auto distance = [](void const* p1, void const* p2) { return (char const*) p2 - (char const*) p1; };
+
+    Regional r01 (1); // No active region. Allocated on the heap.
+    {
+        impl_ptr_region region;
+
+        Regional r11 (1);
+        Regional r12 (2);
+        Regional r13 (r01); // Copied into the active region.
+
+        BOOST_TEST(r11.value() == 1);
+        BOOST_TEST(r12.value() == 2);
+        BOOST_TEST(r13.value() == 1);
+        BOOST_TEST(distance(&*r11, &*r12) == sizeof(int)); // Bump-allocated.
+        BOOST_TEST(distance(&*r12, &*r13) == sizeof(int));
+        {
+            impl_ptr_region inner;
+            Regional r21 (3);
+
+            BOOST_TEST(impl_ptr_region::current() == &inner);
+            BOOST_TEST(distance(&*r13, &*r21) != sizeof(int));
+        }
+        BOOST_TEST(impl_ptr_region::current() == &region);
+
+        Regional r14 (std::move(r11)); // Moved, not allocated.
+
+        r01 = r12; // The value is assigned. The heap implementation stays on the heap.
+
+        BOOST_TEST(r14.value() == 1);
+        BOOST_TEST(r01.value() == 2);
+    }
+    BOOST_TEST(impl_ptr_region::current() == nullptr);
+    BOOST_TEST(r01.value() == 2);
+
+    bool thrown = false;
+
+    try { Scratch s01 (1); } catch (std::logic_error const&) { thrown = true; }
+
+    BOOST_TEST(thrown); // policy::skip_destructors requires a region.
+
+    Scratch s02 = boost::impl_ptr<Scratch>::null();
+    {
+        impl_ptr_region region;
+        Scratch s11 (1);
+
+        BOOST_TEST(s11.value() == 1);
+
+        s02 = std::move(s11);
+    }
+    // s02 outlived its region. Not to be accessed but safe to be destroyed.
+}
+
+static
+void
+test_pool()
+{
+    Pooled::reserve(1000);
+
+    BOOST_TEST(1000 <= Pooled::capacity());
+
+    size_t const capacity = Pooled::capacity();
+    void const*   address = nullptr;
+    {
+        Pooled p11 (1);
+        Pooled p12 (p11);
+
+        BOOST_TEST(p11.value() == 1);
+        BOOST_TEST(p12.value() == 1);
+        BOOST_TEST(&*p11 != &*p12);
+
+        address = &*p11;
+    }
+    Pooled p21 (2);
+
+    BOOST_TEST(&*p21 == address); // The last freed slot (p11 outlived p12) is reused first.
+    BOOST_TEST(p21.value() == 2);
+
+    std::vector<Pooled> pooled;
+
+    for (int k = 0; k < 500; ++k)
+        pooled.emplace_back(k);
+
+    std::thread([&]{ pooled.clear(); }).join(); // Slots are returned from another thread.
+    std::thread([&]
+    {
+        std::vector<Pooled> more (300, Pooled(3)); // Slots are taken on another thread.
+
+        BOOST_TEST(more.back().value() == 3);
+    })
+    .join();
+
+    BOOST_TEST(Pooled::capacity() == capacity); // Reserved slots were enough.
+}
+
+static
+void
+test_affine()
+{
+    Handed      h01 (1); // The heap of this thread is created.
+    void const* address = &*h01;
+
+    std::thread([&]{ h01 = boost::impl_ptr<Handed>::null(); }).join(); // Returned to this thread.
+
+    Handed h02 (2); // The return queue is reclaimed.
+
+    BOOST_TEST(&*h02 == address);
+    BOOST_TEST(h02.value() == 2);
+
+    Handed h03 (h02);
+
+    address = &*h03;
+    h03 = boost::impl_ptr<Handed>::null(); // Freed locally.
+
+    Handed h04 (4);
+
+    BOOST_TEST(&*h04 == address);
+
+    // Produced on one thread, consumed on another.
+    std::vector<Handed> handed;
+
+    std::thread([&]{ for (int k = 0; k < 1000; ++k) handed.emplace_back(k); }).join(); // The heap is abandoned.
+    std::thread([&]
+    {
+        int sum = 0;
+
+        for (Handed const& h : handed) sum += h.value();
+
+        BOOST_TEST(sum == 999 * 1000 / 2);
+
+        handed.clear(); // Pushed onto the return queue of the abandoned heap.
+    })
+    .join();
+
+    std::thread([&]{ Handed h (5); BOOST_TEST(h.value() == 5); }).join(); // The abandoned heap is adopted.
+}
+
 static
 void
 test_bool_conversions()
@@ -287,11 +1356,31 @@ main(int argc, char const* argv[])
     test_null();
     test_is_pimpl();
     test_shared();
+    test_local_shared();
+    test_biased();
+    test_intrusive();
+    test_interned();
+    test_weak();
+    test_lazy();
+    test_batch();
+    test_vector();
+    test_soa();
+    test_replicated();
+    test_atomic();
     test_copied();
     test_unique();
     test_inplace();
     test_always_inplace();
+    test_trivial();
     test_bool_conversions();
+    test_small();
+    test_cow();
+    test_relocation();
+    test_allocators();
+    test_pmr();
+    test_region();
+    test_pool();
+    test_affine();
     test_runtime_polymorphic_behavior();
     test_swap();
 
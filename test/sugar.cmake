@@ -1,12 +1,31 @@
 sugar_files(TEST_SOURCES
         allocator.hpp
         impl.cpp
+        impl_affine.cpp
+        impl_allocated.cpp
+        impl_atomic.cpp
+        impl_batch.cpp
+        impl_biased.cpp
+        impl_body.cpp
         impl_always_inplace.cpp
         impl_copied.cpp
+        impl_cow.cpp
         impl_inplace.cpp
+        impl_interned.cpp
+        impl_lazy.cpp
+        impl_intrusive.cpp
+        impl_local_shared.cpp
+        impl_pmr.cpp
+        impl_point.cpp
         impl_poly.cpp
+        impl_pool.cpp
+        impl_region.cpp
+        impl_replicated.cpp
         impl_shared.cpp
+        impl_small.cpp
+        impl_trivial.cpp
         impl_unique.cpp
+        impl_weak.cpp
         main.cpp
         test.hpp
         )
\ No newline at end of file
@@ -2,8 +2,11 @@
 #define IMPL_PTR_TEST_HPP
 
 #include "../include/impl_ptr.hpp"
+#include "../include/detail/pmr.hpp"
+#include "./allocator.hpp"
 #include <boost/detail/lightweight_test.hpp>
 #include <string>
+#include <vector>
 
 using string = std::string;
 namespace policy = impl_ptr_policy;
@@ -17,6 +20,8 @@ struct Book : boost::impl_ptr<Book, policy::shared>
     string const& author () const;
 };
 
+IMPL_PTR_EXTERN_TEMPLATE(Book, policy::shared);
+
 struct test
 {
     struct singleton_type {};
@@ -28,6 +33,8 @@ struct Foo {};
 
 struct Shared : boost::impl_ptr<Shared>::shared // Pure interface.
 {
+    using trivially_relocatable = std::true_type; // Opted in: no special members of its own.
+
     Shared ();
     Shared (int);
     Shared (int, int);
@@ -45,8 +52,106 @@ struct Shared : boost::impl_ptr<Shared>::shared // Pure interface.
     int    value () const;
 };
 
+struct Local : boost::impl_ptr<Local, policy::local_shared>
+{
+    Local (int);
+
+    int value () const;
+};
+
+struct Session : boost::impl_ptr<Session, policy::biased>
+{
+    Session (int);
+
+    int value () const;
+
+    static int instances (); // Live implementations.
+};
+
+struct Node : boost::impl_ptr<Node, policy::intrusive>
+{
+    Node (int);
+    Node (int, string const&); // Derived implementation.
+
+    int value () const;
+
+    static int derived_instances ();
+};
+
+struct Deferred : boost::impl_ptr<Deferred, policy::lazy>
+{
+    Deferred (int, string const&); // Constructed on first access.
+    Deferred (Deferred const*);    // Reads the other one when constructed.
+
+    int value () const;
+
+    static int constructed (); // Implementations constructed so far.
+};
+
+struct Batched : boost::impl_ptr<Batched, policy::copied_batch> // Allocated in blocks by make_n()/clone().
+{
+    Batched (int);
+    Batched (int, long double); // Derived implementation aligned more than the base.
+
+    int         value () const;
+    void        value (int);
+    char const* address () const;
+
+    static std::vector<Batched> make (size_t, int);                  // make_n()
+    static std::vector<Batched> copy (std::vector<Batched> const&); // clone()
+    static int             instances ();                            // Live implementations.
+};
+
+struct Point : boost::impl_ptr<Point, policy::copied> // Kept in impl_vector.
+{
+    Point (int);
+
+    int         value () const;
+    char const* address () const;
+
+    static void append (boost::impl_vector<Point>&, int from, int to); // emplace_back()
+    static void repeat (boost::impl_vector<Point>&, size_t);           // push_back(v[k])
+    static int  instances ();                                          // Live implementations.
+};
+
+struct Body : boost::impl_ptr<Body, policy::copied> // Kept in impl_soa.
+{
+    Body (double x, double v, std::string const& name);
+
+    double             x () const;
+    double             v () const;
+    std::string const& name () const;
+
+    // Where the implementation is visible.
+    static std::vector<Body> advance (std::vector<Body> const&, double dt); // Loops over the columns.
+    static std::vector<Body> reverse (std::vector<Body> const&);            // Element proxies.
+    static bool              aligned (std::vector<Body> const&);            // The columns.
+};
+
+struct Settings : boost::impl_ptr<Settings, policy::replicated> // Read-mostly. Shared by all threads.
+{
+    Settings (int);
+    Settings (test::singleton_type);
+
+    int  value () const;
+    void value (int); // Updates all replicas.
+
+    static int instances (); // Live replicas (current and superseded).
+};
+
+struct Routes : boost::impl_ptr<Routes, policy::shared> // Swapped at run-time.
+{
+    Routes (int);
+
+    int value () const;
+
+    static int instances (); // Live implementations.
+};
+
 struct Unique : boost::impl_ptr<Unique>::unique // Pure interface.
 {
+    using trivially_relocatable = std::true_type;
+
     Unique ();
     Unique (int);
 
@@ -54,8 +159,12 @@ struct Unique : boost::impl_ptr<Unique>::unique // Pure interface.
     int    value () const;
 };
 
+IMPL_PTR_EXTERN_TEMPLATE(Unique, policy::unique);
+
 struct Copied : boost::impl_ptr<Copied>::copied // Pure interface.
 {
+    using trivially_relocatable = std::true_type;
+
     Copied ();
     Copied (int);
 
@@ -68,6 +177,8 @@ struct Copied : boost::impl_ptr<Copied>::copied // Pure interface.
     int    value () const;
 };
 
+IMPL_PTR_EXTERN_TEMPLATE(Copied, policy::copied);
+
 //struct InPlace : boost::impl_ptr<InPlace>::onstack<int[16]>
 struct InPlace : boost::impl_ptr<InPlace, policy::inplace, policy::storage<64>>
 {
@@ -97,6 +208,134 @@ struct AlwaysInPlace : boost::impl_ptr<AlwaysInPlace, policy::always_inplace, po
     int    value () const;
 };
 
+// POD-like implementations. Copied, moved and destroyed with no calls into the implementation file.
+struct Trivial : boost::impl_ptr<Trivial, policy::inplace, policy::storage<16>, policy::trivially_copyable>
+{
+    using trivially_relocatable = std::true_type;
+
+    Trivial (int, int);
+
+    int sum () const;
+};
+
+struct Packed : boost::impl_ptr<Packed, policy::always_inplace, policy::storage<16>> // Triviality detected at run time.
+{
+    Packed (int, int);
+
+    int sum () const;
+};
+
+// The null state is in the last byte of the storage. No memory overhead.
+struct Compact : boost::impl_ptr<Compact, policy::inplace, policy::storage<16, 8>, policy::tail_flag>
+{
+    Compact (int, int);
+
+    int sum () const;
+};
+
+static_assert(sizeof(Compact) == 16, "policy::tail_flag causes memory overhead");
+
+// The null state in the last byte and swapped with memcpy.
+struct CompactTrivial : boost::impl_ptr<CompactTrivial, policy::inplace, policy::storage<16, 8>, policy::trivially_copyable, policy::tail_flag>
+{
+    CompactTrivial (int, int);
+
+    int sum () const;
+};
+
+struct Small : boost::impl_ptr<Small, policy::small, policy::storage<32>>
+{
+    Small (int);      // Fits the storage.
+    Small (int, int); // Large (derived) implementation.
+    Small (double);   // Small (derived) implementation throwing on move.
+    Small (long);     // Small (derived) implementation. In place.
+
+    int value () const;
+};
+
+struct Allocated : boost::impl_ptr<Allocated, policy::copied, arena_allocator<void>>
+{
+    Allocated (arena&, int);
+
+    int value () const;
+};
+
+struct Pmr : boost::impl_ptr<Pmr, policy::pmr_copied>
+{
+    Pmr (int);
+    Pmr (policy::pmr::memory_resource*, int);
+
+    int value () const;
+};
+
+struct PmrUnique : boost::impl_ptr<PmrUnique, policy::pmr_unique>
+{
+    PmrUnique (policy::pmr::memory_resource*, int);
+
+    int value () const;
+};
+
+struct Regional : boost::impl_ptr<Regional, policy::copied_region>
+{
+    Regional (int);
+
+    int value () const;
+};
+
+struct Scratch : boost::impl_ptr<Scratch, policy::region, policy::skip_destructors>
+{
+    Scratch (int);
+
+    int value () const;
+};
+
+struct Pooled : boost::impl_ptr<Pooled, policy::copied_pool>
+{
+    using trivially_relocatable = std::true_type;
+
+    Pooled (int);
+
+    int value () const;
+
+    static void     reserve (size_t);
+    static size_t  capacity ();
+};
+
+struct Handed : boost::impl_ptr<Handed, policy::copied_affine>
+{
+    Handed (int);
+
+    int value () const;
+};
+
+struct Document : boost::impl_ptr<Document, policy::cow>
+{
+    Document (string const&);
+
+    string text () const;    // Shared.
+    void append (string const&); // Detached.
+};
+
+struct Title : boost::impl_ptr<Title, policy::intrusive>
+{
+    Title (boost::string_view); // Interned.
+
+    string text () const;
+
+    static Title    find (boost::string_view); // Null when not interned yet.
+    static size_t interned ();
+};
+
+struct Cached : boost::impl_ptr<Cached>::shared
+{
+    Cached (int); // From the cache (2 most recently used kept alive).
+
+    int value () const;
+
+    static int    instances (); // Live implementations.
+    static size_t    cached (); // Cache entries.
+};
+
 struct Base : boost::impl_ptr<Base>::shared
 {
     Base (int);